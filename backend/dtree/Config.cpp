@@ -21,6 +21,14 @@ DEFINE_bool(storage_node, false, "is storage node? ");
 DEFINE_uint64(compute_nodes, 1,"Number nodes participating");
 DEFINE_uint64(storage_nodes, 1,"Number nodes participating");
 DEFINE_double(rdmaMemoryFactor, 1.1, "Factor to be multiplied by dramGB"); // factor to be multiplied by dramGB
+DEFINE_double(blob_heap_percentage, 0, "Percentage of the node region reserved for out-of-line values of the one-sided tree");
+DEFINE_uint32(replication_level, 0, "Inner nodes of the one-sided tree on this level and above are copied to further storage nodes, 0 disables");
+DEFINE_string(allocation_policy, "random", "Storage node of pages created by one-sided splits: random, sibling, parent, round_robin or least_loaded");
+DEFINE_bool(split_hints, false, "Compute nodes announce nearly full one-sided nodes and storage nodes split them locally; the NIC must support global atomicity (IBV_ATOMIC_GLOB)");
+DEFINE_bool(cluster_leaves, false, "Storage nodes relocate the leaves below each local level 1 inner node to consecutive pages so that scans read several leaves with one READ; plain tree only, the NIC must support global atomicity (IBV_ATOMIC_GLOB)");
+DEFINE_bool(storage_writes, false, "One-sided inserts locate the leaf with one-sided reads and let the storage node owning it apply the upsert; requires IBV_ATOMIC_GLOB like --split_hints");
+DEFINE_bool(in_place_updates, false, "Updates and upserts of existing keys in the one-sided tree CAS the value slot instead of latching, reading and writing back the leaf; with --split_hints or --storage_writes the storage nodes latch leaves with CPU atomics, which again requires IBV_ATOMIC_GLOB");
+DEFINE_uint64(leaf_cache_mb, 0, "Size of the cache of hot one-sided leaves per compute node, split over the workers; a cached leaf is validated by reading its header instead of the leaf, 0 disables");
 DEFINE_uint32(port, 7174, "port");
 DEFINE_string(ownIp, "172.18.94.80", "own IP server");
 // -------------------------------------------------------------------------------------
@@ -29,6 +29,14 @@ DECLARE_bool(storage_node); // true if it is a storage node
 DECLARE_uint64(compute_nodes);
 DECLARE_string(ownIp);
 DECLARE_double(rdmaMemoryFactor); // factor to be multiplied by dramGB
+DECLARE_double(blob_heap_percentage); // share of the node region used for out-of-line values
+DECLARE_uint32(replication_level); // one-sided inner nodes on this level and above are replicated
+DECLARE_string(allocation_policy); // storage node of pages created by one-sided splits
+DECLARE_bool(split_hints); // one-sided nodes are pre-split by a maintenance thread on the storage nodes
+DECLARE_bool(storage_writes); // one-sided inserts are applied by the storage node owning the leaf
+DECLARE_bool(cluster_leaves); // a maintenance thread on the storage nodes relocates key-adjacent leaves next to each other
+DECLARE_bool(in_place_updates); // values of existing keys are updated with a remote CAS instead of the leaf latch
+DECLARE_uint64(leaf_cache_mb); // compute-side copies of hot leaves of the one-sided tree, validated by a header read
 DECLARE_uint32(port);
 DECLARE_uint64(pollingInterval);
 DECLARE_bool(read);
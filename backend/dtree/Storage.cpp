@@ -31,31 +31,57 @@ Storage::Storage() {
    barrier = (uint64_t*)cm->getGlobalBuffer().allocate(sizeof(uint64_t), 64);
    cache_counter = (uint64_t*)cm->getGlobalBuffer().allocate(sizeof(uint64_t), 64);
    md = (onesided::MetadataPage*)cm->getGlobalBuffer().allocate(sizeof(onesided::MetadataPage), 64);
-   uint64_t number_nodes = static_cast<uint64_t>(((FLAGS_dramGB * 0.8) * 1024 * 1024 * 1024) / BTREE_NODE_SIZE);
-   std::cout << "number nodes " << number_nodes << std::endl;
+   blob_counter = (uint64_t*)cm->getGlobalBuffer().allocate(sizeof(uint64_t), 64);
+   auto region_bytes = static_cast<uint64_t>((FLAGS_dramGB * 0.8) * 1024 * 1024 * 1024);
+   blob_heap_size = static_cast<uint64_t>(static_cast<double>(region_bytes) * (FLAGS_blob_heap_percentage / 100.0));
+   blob_heap_size -= blob_heap_size % BLOB_CHUNK_SIZE;
+   uint64_t number_nodes = (region_bytes - blob_heap_size) / BTREE_NODE_SIZE;
+   std::cout << "number nodes " << number_nodes << " blob heap bytes " << blob_heap_size << std::endl;
    node_buffer = (uint8_t*)cm->getGlobalBuffer().allocate(BTREE_NODE_SIZE * number_nodes, 64);
+   if (blob_heap_size > 0) blob_heap = (uint8_t*)cm->getGlobalBuffer().allocate(blob_heap_size, 64);
    // latch every node in this remote cache region (simplifies allocation)
-   auto* nodes = static_cast<onesided::BTreeLeaf<uint64_t, uint64_t>*>(static_cast<void*>(node_buffer));
+   auto* nodes = static_cast<onesided::ActiveLeaf<uint64_t, uint64_t>*>(static_cast<void*>(node_buffer));
    for (size_t i = 0; i < number_nodes; i++) {
-      onesided::allocateInRDMARegion<onesided::BTreeLeaf<uint64_t, uint64_t>>(&nodes[i]);
+      onesided::allocateInRDMARegion<onesided::ActiveLeaf<uint64_t, uint64_t>>(&nodes[i]);
       nodes[i].remote_latch = onesided::EXCLUSIVE_LOCKED;
    }
    auto iptr = reinterpret_cast<std::uintptr_t>(md);
    if ((iptr % 64) != 0) { throw std::runtime_error("not aligned"); }
    onesided::allocateInRDMARegion<onesided::MetadataPage>(md);
+   split_hints = (onesided::SplitHintRing*)cm->getGlobalBuffer().allocate(sizeof(onesided::SplitHintRing), 64);
+   onesided::allocateInRDMARegion<onesided::SplitHintRing>(split_hints);
    ensure(md->type == onesided::PType_t::METADATA);
-   root = static_cast<onesided::BTreeLeaf<Key, Value>*>(cm->getGlobalBuffer().allocate(BTREE_NODE_SIZE, 64));
-   onesided::allocateInRDMARegion<onesided::BTreeLeaf<Key, Value>>(root);
+   root = static_cast<onesided::ActiveLeaf<Key, Value>*>(cm->getGlobalBuffer().allocate(BTREE_NODE_SIZE, 64));
+   onesided::allocateInRDMARegion<onesided::ActiveLeaf<Key, Value>>(root);
    RemotePtr root_ptr(nodeId, (uintptr_t)root);
    md->setRootPtr(root_ptr);
    // create first root node
    *barrier = 0;
    *cache_counter = 0;
+   *blob_counter = 0;
 }
 
 Storage::~Storage() {
+   stopMaintenance();
    stopProfiler();
    mh.reset();
    std::cout << "Destructing storage " << md->getRootPtr().offset << "\n";
 }
+
+void Storage::startMaintenance() {
+   maintenanceRunning = true;
+   maintenanceThread = std::thread([this]() {
+      onesided::SplitDaemon<Key, Value> daemon(*split_hints, nodeId, *cache_counter, node_buffer);
+      onesided::LeafClusterer<Key, Value> clusterer(nodeId, *cache_counter, node_buffer);
+      daemon.run(maintenanceRunning, [&]() {
+         if (FLAGS_cluster_leaves) clusterer.step();
+      });
+      std::cout << "Split daemon splits " << daemon.splits << " clustered leaf runs " << clusterer.runs << "\n";
+   });
+}
+
+void Storage::stopMaintenance() {
+   maintenanceRunning = false;
+   if (maintenanceThread.joinable()) maintenanceThread.join();
+}
 }  // namespace dtree
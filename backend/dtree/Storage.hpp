@@ -7,12 +7,18 @@
 #include "threads/CoreManager.hpp"
 #include "threads/WorkerPool.hpp"
 #include "db/btree.hpp"
+#include "db/VarKeyBTree.hpp"
 #include "db/OneSidedTypes.hpp"
 #include "dtree/utils/RandomGenerator.hpp"
 #include "dtree/db/OneSidedBTree.hpp"
+#include "dtree/db/OneSidedLeafClusterer.hpp"
+#include "dtree/db/OneSidedSplitDaemon.hpp"
+#include "dtree/db/OneSidedStorageOps.hpp"
 #include "dtree/db/OneSidedTypes.hpp"
 // -------------------------------------------------------------------------------------
+#include <atomic>
 #include <memory>
+#include <thread>
 
 namespace dtree
 {
@@ -68,6 +74,10 @@ class Storage
       mh = std::make_unique<rdma::MessageHandler>(*cm, *this, nodeId);
    };
 
+   // pre-splits one-sided nodes announced in split_hints (--split_hints) and clusters leaves (--cluster_leaves)
+   void startMaintenance();
+   void stopMaintenance();
+
    std::atomic<uint64_t>& getConnectedClients(){
       return mh->connectedClients;
    }
@@ -75,20 +85,31 @@ class Storage
    auto& getTree(){
       return tree;
    }
+
+   auto& getVarTree(){
+      return var_tree;
+   }
    
    uint64_t* barrier;
    uint64_t* cache_counter;
    onesided::MetadataPage* md;
    uint8_t *node_buffer {nullptr};
-   dtree::onesided::BTreeLeaf<Key, Value>* root ;
+   uint64_t* blob_counter;
+   uint8_t* blob_heap {nullptr};
+   uint64_t blob_heap_size {0};
+   onesided::SplitHintRing* split_hints {nullptr};
+   dtree::onesided::ActiveLeaf<Key, Value>* root ;
   private:
    NodeID nodeId = 0;
    twosided::BTree<Key,Value> tree;
+   twosided::VarKeyBTree<Value> var_tree;
    std::unique_ptr<rdma::MessageHandler> mh;
    std::unique_ptr<rdma::CM<rdma::InitMessage>> cm;
    std::unique_ptr<profiling::RDMACounters> rdmaCounters;
    profiling::ProfilingThread pt;
    std::vector<std::thread> profilingThread;
+   std::atomic<bool> maintenanceRunning {false};
+   std::thread maintenanceThread;
    
 
 };
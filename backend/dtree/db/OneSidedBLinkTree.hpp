@@ -0,0 +1,166 @@
+#pragma once
+#include <array>
+#include <cstdint>
+
+#include "Defs.hpp"
+#include "OneSidedBTree.hpp"
+//=== One-sided B-link Tree ===//
+// B-link variant of the one-sided tree (Lehman and Yao): every node carries a right link and its upper fence acts as
+// high key. A split latches only the node being split; the separator is published in the parent afterwards in a
+// second phase with the child already unlatched. Until then operations that land on a node which no longer covers
+// their key follow the right link. Shares the node layout with BTree, but both variants must not operate on the same
+// tree since BTree does not follow right links.
+
+namespace dtree {
+namespace onesided {
+
+template <typename Key, typename Value, typename LeafT = ActiveLeaf<Key, Value>>
+struct BLinkTree {
+   using Tree = BTree<Key, Value, LeafT>;
+   using KeyType = Key;
+   using ValueType = Value;
+   using Leaf = LeafT;
+   using Inner = BTreeInner<Key>;
+   using FillHint = typename Inner::FillHint;
+   static constexpr uint8_t MAX_HEIGHT{32};
+   using Path = std::array<RemotePtr, MAX_HEIGHT>;  // inner node passed per level during the descent
+   Tree tree;
+   BLinkTree(RemotePtr metadata) : tree(metadata) {}
+
+   static bool covers(GuardO<NodePlaceholder>& node, const Key& key) {
+      auto upper = (node->getNodeType() == BTreeNodeType::INNER) ? node->as<Inner>()->fenceKeys.getUpper()
+                                                                 : node->as<Leaf>()->fenceKeys.getUpper();
+      return upper.isInfinity || key <= upper.key;
+   }
+   // the separator of a split may not have reached the parent yet, the key then lives further right
+   static void move_right(GuardO<NodePlaceholder>& node, const Key& key) {
+      while (!covers(node, key)) {
+         auto right = node->getRightLink();
+         node.checkVersionAndRestart();
+         node = GuardO<NodePlaceholder>(right);
+      }
+   }
+
+   GuardO<NodePlaceholder> descend(const Key& key, uint8_t level = 0, Path* path = nullptr) {
+      GuardO<NodePlaceholder> parent;
+      GuardO<NodePlaceholder> node(tree.read_root());
+      move_right(node, key);
+      ensure(node->level >= level);
+      while (node->level > level) {
+         if (path) (*path)[node->level] = node.latch.remote_ptr;
+         parent = std::move(node);
+         auto* inner = parent->as<Inner>();
+         if (inner->level == 1)
+            node = tree.read_leaf(inner, inner->lower_bound(key));
+         else
+            node = GuardO<NodePlaceholder>(inner->next_child(key));
+         parent.checkVersionAndRestart();
+         move_right(node, key);
+      }
+      parent.release();
+      return node;
+   }
+
+   // second phase of a split: publishes sep -> right on the given level. A full parent is split the same way and
+   // its separator published one level up before this separator is retried.
+   void install_separator(Path& path, uint8_t level, Key sep, RemotePtr left, RemotePtr right, FillHint left_fill,
+                          FillHint right_fill) {
+      ensure(level < MAX_HEIGHT);
+      for ([[maybe_unused]] size_t repeat = 0;; repeat++) {
+         try {
+            if (path[level] == NULL_REMOTEPTR) {
+               // the split node was the root when we passed it
+               GuardX<MetadataPage> g_metadata(tree.metadata);
+               if (g_metadata->getRootPtr() == left) {
+                  tree.make_new_root(g_metadata, sep, left, right, level, left_fill, right_fill);
+                  return;
+               }
+               g_metadata.release();
+               // another split grew the tree in the meantime
+               auto node = descend(sep, level);
+               path[level] = node.latch.remote_ptr;
+               node.release();
+            }
+            GuardO<NodePlaceholder> node(path[level]);
+            move_right(node, sep);
+            SeparatorInfo<Key> sepInfo;
+            RemotePtr split_node;
+            {
+               GuardX<NodePlaceholder> parent(std::move(node));
+               typename Tree::ReplicaLatches parent_replicas(parent);
+               if (parent->as<Inner>()->has_space()) {
+                  parent->as<Inner>()->insert_link(sep, right, right_fill);
+                  parent_replicas.apply(parent);
+                  return;
+               }
+               auto grandparent = (level + 1 < MAX_HEIGHT) ? path[level + 1] : NULL_REMOTEPTR;
+               sepInfo = parent->as<Inner>()->split(tree.place(parent.latch.remote_ptr, grandparent));
+               split_node = parent.latch.remote_ptr;
+               parent_replicas.apply(parent);
+            }  // nothing stays latched while the separator moves up
+            install_separator(path, static_cast<uint8_t>(level + 1), sepInfo.sep, split_node, sepInfo.rightNode,
+                              Inner::UNKNOWN_FILL, Inner::UNKNOWN_FILL);
+         } catch (const OLCRestartException&) {
+            ensure(threads::onesided::Worker::my().local_rmemory.get_size() == CONCURRENT_LATCHES);
+         }
+      }
+   }
+
+   bool lookup(Key key, Value& retValue) {
+      for ([[maybe_unused]] size_t repeat = 0;; repeat++) {
+         try {
+            GuardO<NodePlaceholder> leaf(descend(key));
+            return leaf->as<Leaf>()->lookup(key, retValue);
+         } catch (const OLCRestartException&) {
+            ensure(threads::onesided::Worker::my().local_rmemory.get_size() == CONCURRENT_LATCHES);
+         }
+      }
+   }
+
+   void insert(Key key, Value value) {
+      for ([[maybe_unused]] size_t repeat = 0;; repeat++) {
+         try {
+            Path path;
+            path.fill(NULL_REMOTEPTR);
+            GuardX<NodePlaceholder> leaf(descend(key, 0, &path));
+            if (leaf->as<Leaf>()->has_space_for(key)) {
+               leaf->as<Leaf>()->upsert(key, value);
+               return;
+            }
+            // first phase: the right half is written before the leaf links to it, no parent is latched
+            auto sepInfo = leaf->as<Leaf>()->split(tree.place(leaf.latch.remote_ptr, path[1]));
+            auto left = leaf.latch.remote_ptr;
+            auto left_fill = Tree::fill_hint(leaf->count);
+            leaf.release();
+            install_separator(path, 1, sepInfo.sep, left, sepInfo.rightNode, left_fill,
+                              Tree::fill_hint(sepInfo.rightCount));
+         } catch (const OLCRestartException&) {
+            ensure(threads::onesided::Worker::my().local_rmemory.get_size() == CONCURRENT_LATCHES);
+         }
+      }
+   }
+
+   // same guarantees as BTree::range_scan; consecutive leaves are reached through the right links
+   template <typename FN>
+   void range_scan(const Key from, const Key to, FN scan_function) {
+      typename Tree::template ScanState<FN> state{scan_function, from, to};
+      for ([[maybe_unused]] size_t repeat = 0;; repeat++) {
+         try {
+            GuardO<NodePlaceholder> leaf(descend(state.resume_key()));
+            for (;;) {
+               auto finished = state.stage(leaf->as<Leaf>());
+               finished |= leaf->as<Leaf>()->fenceKeys.getUpper().isInfinity;
+               auto right = leaf->getRightLink();
+               leaf.release();
+               state.deliver();
+               if (finished) return;
+               leaf = GuardO<NodePlaceholder>(right);
+            }
+         } catch (const OLCRestartException&) {
+            ensure(threads::onesided::Worker::my().local_rmemory.get_size() == CONCURRENT_LATCHES);
+         }
+      }
+   }
+};
+}  // namespace onesided
+}  // namespace dtree
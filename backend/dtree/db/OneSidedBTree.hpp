@@ -11,12 +11,20 @@
 #include <cstring>
 #include <functional>
 #include <iostream>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <optional>
 #include <stdexcept>
+#include <string_view>
 #include <type_traits>
+#include <unordered_map>
+#include <utility>
 #include <vector>
 
 #include "Defs.hpp"
 #include "OneSidedLatches.hpp"
+#include "OneSidedLeafCache.hpp"
 #include "OneSidedTypes.hpp"
 //=== One-sided B-Tree ===//
 
@@ -29,6 +37,7 @@ template <typename Key>
 struct SeparatorInfo {
    Key sep;
    RemotePtr rightNode;
+   Pos rightCount{0};  // entries moved to the right node
 };
 
 template <class Key>
@@ -53,9 +62,26 @@ struct BTreeHeader : public PageHeader {
    using header = PageHeader;
    static constexpr uint64_t bytes = BTREE_NODE_SIZE;
    uint16_t count{0};
+   uint8_t level{0};  // leaves are level 0
+   uint8_t append_streak{0};  // inserts in a row at the end of the node
+   uint8_t retired{0};  // the node moved to another page, this one only keeps a stale copy
+   // after this many appends splits keep the left node full instead of halving it (time-ordered or auto-increment keys)
+   static constexpr uint8_t APPEND_STREAK_SPLIT{8};
+   void track_append(bool at_end) {
+      append_streak = at_end ? static_cast<uint8_t>(std::min(append_streak + 1, 255)) : static_cast<uint8_t>(0);
+   }
+   Pos split_position() {
+      if (append_streak >= APPEND_STREAK_SPLIT && count > 2) return static_cast<Pos>(count - 2);
+      return count / 2;
+   }
    void setNodeType(BTreeNodeType node_type) { header::btpg.node_type = node_type; }
    BTreeNodeType getNodeType() { return header::btpg.node_type; }
-   BTreeHeader(BTreeNodeType node_type) : PageHeader(PType_t::BTREE_NODE) { setNodeType(node_type); }
+   void setRightLink(RemotePtr right) { header::btpg.right_link = right; }
+   RemotePtr getRightLink() { return header::btpg.right_link; }
+   BTreeHeader(BTreeNodeType node_type) : PageHeader(PType_t::BTREE_NODE) {
+      setNodeType(node_type);
+      setRightLink(NULL_REMOTEPTR);
+   }
 };
 
 template <typename Key, typename Value>
@@ -68,6 +94,9 @@ struct BTreeLeaf : public BTreeHeader {
    std::array<Key, max_entries> keys;
    std::array<Value, max_entries> values;
    uint8_t padding[bytes_padding];
+   static constexpr bool partial_reads{false};
+   static constexpr bool truncated_reads{false};  // values follow the full key array
+   static uint64_t bytes_for([[maybe_unused]] Pos entries) { return sizeof(BTreeLeaf); }
 
    BTreeLeaf() : BTreeHeader(BTreeNodeType::LEAF) {
       static_assert(sizeof(BTreeLeaf) == BTREE_NODE_SIZE, "btree node size problem");
@@ -80,12 +109,13 @@ struct BTreeLeaf : public BTreeHeader {
 
    bool lookup(const Key& key, Value& retValue) {
       auto idx = lower_bound(key);
-      if (idx == end() && key_at(idx) != key) return false;
+      if (idx == end() || key_at(idx) != key) return false;
       retValue = value_at(idx);
       return true;
    }
    void insert(const Key& key, const Value& value) {
       Pos position = lower_bound(key);
+      track_append(position == end());
       if (position != end()) {
          std::move(std::begin(keys) + position, std::begin(keys) + end(), std::begin(keys) + position + 1);
          std::move(std::begin(values) + position, std::begin(values) + end(), std::begin(values) + position + 1);
@@ -107,34 +137,47 @@ struct BTreeLeaf : public BTreeHeader {
       insert(key, value);
    }
 
-   SeparatorInfo<Key> split() {
+   SeparatorInfo<Key> split(NodeID placement = EMPTY_NODEID) {
       assert(count == max_entries);  // only split if full
+      AllocationLatch<BTreeLeaf> rightNode(placement);
+      auto sepInfo = split_into(rightNode.operator->(), rightNode.remote_ptr);
+      rightNode.unlatch();
+      return sepInfo;
+   }
+   // fills right, an empty node that is published at right_ptr by the caller
+   SeparatorInfo<Key> split_into(BTreeLeaf* right, RemotePtr right_ptr) {
+      assert(count > 1);
       SeparatorInfo<Key> sepInfo;
-      AllocationLatch<BTreeLeaf> rightNode;
       Pos sepPosition = find_separator();
+      right->append_streak = std::exchange(append_streak, static_cast<uint8_t>(0));
+      // the right node takes over the old link before it is written back, this node points to it afterwards
+      right->setRightLink(getRightLink());
+      setRightLink(right_ptr);
       sepInfo.sep = keys[sepPosition];
-      sepInfo.rightNode = rightNode.remote_ptr;
+      sepInfo.rightNode = right_ptr;
       // move from one node to the other; keep separator key in the left child
-      std::move(std::begin(keys) + sepPosition + 1, std::begin(keys) + end(), std::begin(rightNode->keys));
-      std::move(std::begin(values) + sepPosition + 1, std::begin(values) + end(), std::begin(rightNode->values));
+      std::move(std::begin(keys) + sepPosition + 1, std::begin(keys) + end(), std::begin(right->keys));
+      std::move(std::begin(values) + sepPosition + 1, std::begin(values) + end(), std::begin(right->values));
       // update counts
-      rightNode->count = count - static_cast<Pos>((sepPosition + static_cast<Pos>(1)));
-      count = count - rightNode->count;
+      right->count = count - static_cast<Pos>((sepPosition + static_cast<Pos>(1)));
+      count = count - right->count;
+      sepInfo.rightCount = right->count;
       // fence
-      rightNode->fenceKeys.setFences({.isInfinity = false, .key = sepInfo.sep},
-                                     fenceKeys.getUpper());  // order is important
+      right->fenceKeys.setFences({.isInfinity = false, .key = sepInfo.sep},
+                                 fenceKeys.getUpper());  // order is important
       fenceKeys.setFences(fenceKeys.getLower(), {.isInfinity = false, .key = sepInfo.sep});
-      rightNode.unlatch();
       return sepInfo;
-   };
+   }
 
-   Pos find_separator() { return count / 2; }
+   Pos find_separator() { return split_position(); }
    bool has_space() { return (count < max_entries); }
+   bool has_space_for([[maybe_unused]] const Key& key) { return has_space(); }
    Pos begin() { return 0; }
    Pos end() { return count; }
    // returns one it behind valid it as usual inline
    Key key_at(Pos idx) { return keys[idx]; }
    inline Value value_at(Pos idx) { return values[idx]; }
+   Value* value_slot(Pos idx) { return &values[idx]; }
    void print_keys() {
       for (auto idx = begin(); idx < end(); idx++) { std::cout << keys[idx] << "\n"; }
    }
@@ -143,20 +186,525 @@ struct BTreeLeaf : public BTreeHeader {
    }
 };
 
+// Leaf with key/value records and a fingerprint cache line.
+// Layout: [header CL][fingerprint CL][fences][records...]; a record never straddles a cache line.
+// Point lookups read the first two CLs, compare fingerprints and fetch only the matching record(s).
+template <typename Key, typename Value>
+struct BTreeFPLeaf : public BTreeHeader {
+   using super = BTreeHeader;
+   struct Record {
+      Key key;
+      Value value;
+   };
+   static constexpr uint64_t header_bytes{2 * CACHE_LINE};  // header + fingerprints
+   static constexpr uint64_t records_offset{header_bytes + sizeof(FenceKeys<Key>)};
+   static constexpr uint64_t leaf_size{BTREE_NODE_SIZE - records_offset};
+   static constexpr uint64_t max_entries{std::min<uint64_t>(leaf_size / sizeof(Record), CACHE_LINE)};
+   static constexpr uint64_t bytes_padding{leaf_size - max_entries * sizeof(Record)};
+   static_assert(CACHE_LINE % sizeof(Record) == 0 && records_offset % sizeof(Record) == 0,
+                 "records must not straddle cache lines");
+   uint8_t header_padding[CACHE_LINE - sizeof(BTreeHeader)];
+   std::array<uint8_t, CACHE_LINE> fingerprints;
+   FenceKeys<Key> fenceKeys;
+   std::array<Record, max_entries> records;
+   uint8_t padding[bytes_padding];
+   static constexpr bool partial_reads{true};
+   static constexpr bool truncated_reads{true};
+   // bytes covering header, fences and the first entries records
+   static uint64_t bytes_for(Pos entries) { return records_offset + std::min<uint64_t>(entries, max_entries) * sizeof(Record); }
+
+   BTreeFPLeaf() : BTreeHeader(BTreeNodeType::LEAF) {
+      static_assert(sizeof(BTreeFPLeaf) == BTREE_NODE_SIZE, "btree node size problem");
+   }
+
+   static uint8_t fingerprint(const Key& key) {
+      return static_cast<uint8_t>((static_cast<uint64_t>(key) * 0x9E3779B97F4A7C15ull) >> 56);
+   }
+   static uint64_t record_offset(Pos idx) { return records_offset + idx * sizeof(Record); }
+
+   // bitmask of slots whose fingerprint matches
+   uint64_t match_fingerprints(uint8_t fp) {
+      uint64_t mask = 0;
+      auto needle = _mm_set1_epi8(static_cast<char>(fp));
+      for (uint64_t i = 0; i < CACHE_LINE; i += 16) {
+         auto line = _mm_loadu_si128(reinterpret_cast<const __m128i*>(fingerprints.data() + i));
+         mask |= static_cast<uint64_t>(static_cast<uint16_t>(_mm_movemask_epi8(_mm_cmpeq_epi8(line, needle)))) << i;
+      }
+      auto valid = std::min<uint64_t>(count, max_entries);
+      return (valid == 64) ? mask : mask & ((uint64_t(1) << valid) - 1);
+   }
+
+   Pos lower_bound(const Key& key) {
+      auto it = std::lower_bound(std::begin(records), std::begin(records) + count, key,
+                                 [](const Record& r, const Key& k) { return r.key < k; });
+      return static_cast<Pos>(std::distance(std::begin(records), it));
+   }
+
+   bool lookup(const Key& key, Value& retValue) {
+      auto idx = lower_bound(key);
+      if (idx == end() || key_at(idx) != key) return false;
+      retValue = value_at(idx);
+      return true;
+   }
+
+   // local copy holds only header and fingerprints; fetch(offset, bytes) reads records on demand
+   template <typename FETCH>
+   bool lookup_partial(const Key& key, Value& retValue, FETCH&& fetch) {
+      for (auto mask = match_fingerprints(fingerprint(key)); mask; mask &= mask - 1) {
+         auto idx = static_cast<Pos>(__builtin_ctzll(mask));
+         fetch(record_offset(idx), sizeof(Record));
+         if (records[idx].key == key) {
+            retValue = records[idx].value;
+            return true;
+         }
+      }
+      return false;
+   }
+
+   void insert(const Key& key, const Value& value) {
+      Pos position = lower_bound(key);
+      track_append(position == end());
+      if (position != end()) {
+         std::move(std::begin(records) + position, std::begin(records) + end(), std::begin(records) + position + 1);
+         std::move(std::begin(fingerprints) + position, std::begin(fingerprints) + end(),
+                   std::begin(fingerprints) + position + 1);
+      }
+      records[position] = {key, value};
+      fingerprints[position] = fingerprint(key);
+      count++;
+   }
+
+   bool update(const Key& key, const Value& value) {
+      Pos position = lower_bound(key);
+      if ((position == end()) || (key_at(position) != key)) return false;
+      records[position].value = value;
+      return true;
+   }
+
+   void upsert(const Key& key, const Value& value) {
+      if (update(key, value)) return;
+      insert(key, value);
+   }
+
+   SeparatorInfo<Key> split(NodeID placement = EMPTY_NODEID) {
+      assert(count == max_entries);  // only split if full
+      AllocationLatch<BTreeFPLeaf> rightNode(placement);
+      auto sepInfo = split_into(rightNode.operator->(), rightNode.remote_ptr);
+      rightNode.unlatch();
+      return sepInfo;
+   }
+   SeparatorInfo<Key> split_into(BTreeFPLeaf* right, RemotePtr right_ptr) {
+      assert(count > 1);
+      SeparatorInfo<Key> sepInfo;
+      Pos sepPosition = find_separator();
+      right->append_streak = std::exchange(append_streak, static_cast<uint8_t>(0));
+      right->setRightLink(getRightLink());
+      setRightLink(right_ptr);
+      sepInfo.sep = records[sepPosition].key;
+      sepInfo.rightNode = right_ptr;
+      // move from one node to the other; keep separator key in the left child
+      std::move(std::begin(records) + sepPosition + 1, std::begin(records) + end(), std::begin(right->records));
+      std::move(std::begin(fingerprints) + sepPosition + 1, std::begin(fingerprints) + end(),
+                std::begin(right->fingerprints));
+      // update counts
+      right->count = count - static_cast<Pos>((sepPosition + static_cast<Pos>(1)));
+      count = count - right->count;
+      sepInfo.rightCount = right->count;
+      // fence
+      right->fenceKeys.setFences({.isInfinity = false, .key = sepInfo.sep},
+                                 fenceKeys.getUpper());  // order is important
+      fenceKeys.setFences(fenceKeys.getLower(), {.isInfinity = false, .key = sepInfo.sep});
+      return sepInfo;
+   }
+
+   Pos find_separator() { return split_position(); }
+   bool has_space() { return (count < max_entries); }
+   bool has_space_for([[maybe_unused]] const Key& key) { return has_space(); }
+   Pos begin() { return 0; }
+   Pos end() { return count; }
+   Key key_at(Pos idx) { return records[idx].key; }
+   inline Value value_at(Pos idx) { return records[idx].value; }
+   Value* value_slot(Pos idx) { return &records[idx].value; }
+   void print_keys() {
+      for (auto idx = begin(); idx < end(); idx++) { std::cout << records[idx].key << "\n"; }
+   }
+   void print_values() {
+      for (auto idx = begin(); idx < end(); idx++) { std::cout << records[idx].value << "\n"; }
+   }
+};
+
+// Leaf with contiguous key/value records directly after the fences.
+// The first n entries occupy a prefix of the node, hence a reader that knows the count reads only that prefix.
+template <typename Key, typename Value>
+struct BTreeRecordLeaf : public BTreeHeader {
+   using super = BTreeHeader;
+   struct Record {
+      Key key;
+      Value value;
+   };
+   static constexpr uint64_t records_offset{sizeof(BTreeHeader) + sizeof(FenceKeys<Key>)};
+   static constexpr uint64_t leaf_size{BTREE_NODE_SIZE - records_offset};
+   static constexpr uint64_t max_entries{leaf_size / sizeof(Record)};
+   static constexpr uint64_t bytes_padding{leaf_size - max_entries * sizeof(Record)};
+   FenceKeys<Key> fenceKeys;
+   std::array<Record, max_entries> records;
+   uint8_t padding[bytes_padding];
+   static constexpr bool partial_reads{false};
+   static constexpr bool truncated_reads{true};
+   static uint64_t bytes_for(Pos entries) { return records_offset + std::min<uint64_t>(entries, max_entries) * sizeof(Record); }
+
+   BTreeRecordLeaf() : BTreeHeader(BTreeNodeType::LEAF) {
+      static_assert(sizeof(BTreeRecordLeaf) == BTREE_NODE_SIZE, "btree node size problem");
+   }
+
+   Pos lower_bound(const Key& key) {
+      auto it = std::lower_bound(std::begin(records), std::begin(records) + count, key,
+                                 [](const Record& r, const Key& k) { return r.key < k; });
+      return static_cast<Pos>(std::distance(std::begin(records), it));
+   }
+
+   bool lookup(const Key& key, Value& retValue) {
+      auto idx = lower_bound(key);
+      if (idx == end() || key_at(idx) != key) return false;
+      retValue = value_at(idx);
+      return true;
+   }
+
+   void insert(const Key& key, const Value& value) {
+      Pos position = lower_bound(key);
+      track_append(position == end());
+      if (position != end())
+         std::move(std::begin(records) + position, std::begin(records) + end(), std::begin(records) + position + 1);
+      records[position] = {key, value};
+      count++;
+   }
+
+   bool update(const Key& key, const Value& value) {
+      Pos position = lower_bound(key);
+      if ((position == end()) || (key_at(position) != key)) return false;
+      records[position].value = value;
+      return true;
+   }
+
+   void upsert(const Key& key, const Value& value) {
+      if (update(key, value)) return;
+      insert(key, value);
+   }
+
+   SeparatorInfo<Key> split(NodeID placement = EMPTY_NODEID) {
+      assert(count == max_entries);  // only split if full
+      AllocationLatch<BTreeRecordLeaf> rightNode(placement);
+      auto sepInfo = split_into(rightNode.operator->(), rightNode.remote_ptr);
+      rightNode.unlatch();
+      return sepInfo;
+   }
+   SeparatorInfo<Key> split_into(BTreeRecordLeaf* right, RemotePtr right_ptr) {
+      assert(count > 1);
+      SeparatorInfo<Key> sepInfo;
+      Pos sepPosition = find_separator();
+      right->append_streak = std::exchange(append_streak, static_cast<uint8_t>(0));
+      right->setRightLink(getRightLink());
+      setRightLink(right_ptr);
+      sepInfo.sep = records[sepPosition].key;
+      sepInfo.rightNode = right_ptr;
+      // move from one node to the other; keep separator key in the left child
+      std::move(std::begin(records) + sepPosition + 1, std::begin(records) + end(), std::begin(right->records));
+      // update counts
+      right->count = count - static_cast<Pos>((sepPosition + static_cast<Pos>(1)));
+      count = count - right->count;
+      sepInfo.rightCount = right->count;
+      // fence
+      right->fenceKeys.setFences({.isInfinity = false, .key = sepInfo.sep},
+                                 fenceKeys.getUpper());  // order is important
+      fenceKeys.setFences(fenceKeys.getLower(), {.isInfinity = false, .key = sepInfo.sep});
+      return sepInfo;
+   }
+
+   Pos find_separator() { return split_position(); }
+   bool has_space() { return (count < max_entries); }
+   bool has_space_for([[maybe_unused]] const Key& key) { return has_space(); }
+   Pos begin() { return 0; }
+   Pos end() { return count; }
+   Key key_at(Pos idx) { return records[idx].key; }
+   inline Value value_at(Pos idx) { return records[idx].value; }
+   Value* value_slot(Pos idx) { return &records[idx].value; }
+   void print_keys() {
+      for (auto idx = begin(); idx < end(); idx++) { std::cout << records[idx].key << "\n"; }
+   }
+   void print_values() {
+      for (auto idx = begin(); idx < end(); idx++) { std::cout << records[idx].value << "\n"; }
+   }
+};
+
+// Frame-of-reference leaf: keys are stored as Delta (16 or 32 bit) offsets from the lower fence key.
+// A key that is too far from the fence switches the leaf to plain 64-bit keys in the same key area (fewer entries);
+// splits re-encode both halves and return to deltas whenever possible.
+enum class KeyEncoding : uint8_t {
+   DELTA = 0,
+   PLAIN64 = 1,
+};
+
+template <typename Key, typename Value, typename Delta>
+struct BTreeDeltaLeaf : public BTreeHeader {
+   static_assert(std::is_unsigned_v<Key> && std::is_unsigned_v<Delta> && sizeof(Delta) < sizeof(Key),
+                 "delta encoding requires unsigned integer keys");
+   static_assert(sizeof(Delta) == 2 || sizeof(Delta) == 4, "only 16 and 32 bit deltas are supported");
+   using super = BTreeHeader;
+   static constexpr uint64_t leaf_size{BTREE_NODE_SIZE - sizeof(BTreeHeader) - sizeof(FenceKeys<Key>) -
+                                       sizeof(uint64_t)};
+   static constexpr uint64_t key_area_for(uint64_t entries) {
+      return (entries * sizeof(Delta) + sizeof(Key) - 1) / sizeof(Key) * sizeof(Key);
+   }
+   static constexpr uint64_t compute_max_entries() {
+      uint64_t entries = leaf_size / (sizeof(Delta) + sizeof(Value));
+      while (key_area_for(entries) + entries * sizeof(Value) > leaf_size) entries--;
+      return entries;
+   }
+   static constexpr uint64_t max_entries{compute_max_entries()};
+   static constexpr uint64_t key_area_bytes{key_area_for(max_entries)};
+   static constexpr uint64_t max_wide_entries{key_area_bytes / sizeof(Key)};
+   static constexpr uint64_t bytes_padding{leaf_size - key_area_bytes - max_entries * sizeof(Value)};
+   FenceKeys<Key> fenceKeys;
+   KeyEncoding encoding{KeyEncoding::DELTA};
+   uint8_t encoding_padding[sizeof(uint64_t) - sizeof(KeyEncoding)];
+   alignas(Key) uint8_t key_area[key_area_bytes];
+   std::array<Value, max_entries> values;
+   uint8_t padding[bytes_padding];
+   static constexpr bool partial_reads{false};
+   static constexpr bool truncated_reads{false};  // values follow the full key area
+   static uint64_t bytes_for([[maybe_unused]] Pos entries) { return sizeof(BTreeDeltaLeaf); }
+
+   BTreeDeltaLeaf() : BTreeHeader(BTreeNodeType::LEAF) {
+      static_assert(sizeof(BTreeDeltaLeaf) == BTREE_NODE_SIZE, "btree node size problem");
+   }
+
+   Delta* deltas() { return reinterpret_cast<Delta*>(key_area); }
+   Key* wide_keys() { return reinterpret_cast<Key*>(key_area); }
+   Key base() { return fenceKeys.isLowerInfinity() ? Key(0) : fenceKeys.getLower().key; }
+   bool fits(const Key& key) {
+      auto b = base();
+      return key >= b && (key - b) <= std::numeric_limits<Delta>::max();
+   }
+   Pos capacity() { return static_cast<Pos>((encoding == KeyEncoding::DELTA) ? max_entries : max_wide_entries); }
+
+   // number of deltas smaller than d; deltas are sorted, so this is the lower bound
+   Pos count_less(Delta d) {
+      const Delta* ds = deltas();
+      Pos pos = 0;
+#ifdef __AVX2__
+      constexpr Pos lanes = 32 / sizeof(Delta);
+      const auto flip = (sizeof(Delta) == 2) ? _mm256_set1_epi16(std::numeric_limits<int16_t>::min())
+                                             : _mm256_set1_epi32(std::numeric_limits<int32_t>::min());
+      const auto needle = _mm256_xor_si256(
+          (sizeof(Delta) == 2) ? _mm256_set1_epi16(static_cast<int16_t>(d)) : _mm256_set1_epi32(static_cast<int32_t>(d)),
+          flip);
+      for (; pos + lanes <= count; pos += lanes) {
+         auto v = _mm256_xor_si256(_mm256_loadu_si256(reinterpret_cast<const __m256i*>(ds + pos)), flip);
+         auto lt = (sizeof(Delta) == 2) ? _mm256_cmpgt_epi16(needle, v) : _mm256_cmpgt_epi32(needle, v);
+         auto less = static_cast<Pos>(__builtin_popcount(static_cast<uint32_t>(_mm256_movemask_epi8(lt))) / sizeof(Delta));
+         if (less != lanes) return static_cast<Pos>(pos + less);
+      }
+#else
+      constexpr Pos lanes = 16 / sizeof(Delta);
+      const auto flip = (sizeof(Delta) == 2) ? _mm_set1_epi16(std::numeric_limits<int16_t>::min())
+                                             : _mm_set1_epi32(std::numeric_limits<int32_t>::min());
+      const auto needle = _mm_xor_si128(
+          (sizeof(Delta) == 2) ? _mm_set1_epi16(static_cast<int16_t>(d)) : _mm_set1_epi32(static_cast<int32_t>(d)), flip);
+      for (; pos + lanes <= count; pos += lanes) {
+         auto v = _mm_xor_si128(_mm_loadu_si128(reinterpret_cast<const __m128i*>(ds + pos)), flip);
+         auto lt = (sizeof(Delta) == 2) ? _mm_cmplt_epi16(v, needle) : _mm_cmplt_epi32(v, needle);
+         auto less = static_cast<Pos>(__builtin_popcount(static_cast<uint32_t>(_mm_movemask_epi8(lt))) / sizeof(Delta));
+         if (less != lanes) return static_cast<Pos>(pos + less);
+      }
+#endif
+      while (pos < count && ds[pos] < d) pos++;
+      return pos;
+   }
+
+   Pos lower_bound(const Key& key) {
+      if (encoding == KeyEncoding::PLAIN64)
+         return static_cast<Pos>(std::distance(wide_keys(), std::lower_bound(wide_keys(), wide_keys() + count, key)));
+      auto b = base();
+      if (key <= b) return 0;
+      if (key - b > std::numeric_limits<Delta>::max()) return count;
+      return count_less(static_cast<Delta>(key - b));
+   }
+
+   bool lookup(const Key& key, Value& retValue) {
+      auto idx = lower_bound(key);
+      if (idx == end() || key_at(idx) != key) return false;
+      retValue = value_at(idx);
+      return true;
+   }
+
+   // rewrites the leaf with the given sorted entries; picks deltas if all keys fit
+   void assign(const Key* keys, const Value* vals, Pos entries) {
+      encoding = std::all_of(keys, keys + entries, [&](const Key& k) { return fits(k); }) ? KeyEncoding::DELTA
+                                                                                          : KeyEncoding::PLAIN64;
+      ensure(entries <= capacity());
+      auto b = base();
+      for (Pos i = 0; i < entries; i++) {
+         if (encoding == KeyEncoding::DELTA)
+            deltas()[i] = static_cast<Delta>(keys[i] - b);
+         else
+            wide_keys()[i] = keys[i];
+         values[i] = vals[i];
+      }
+      count = entries;
+   }
+
+   void decode(Key* keys) {
+      for (Pos i = 0; i < count; i++) keys[i] = key_at(i);
+   }
+
+   void insert(const Key& key, const Value& value) {
+      if (encoding == KeyEncoding::DELTA && !fits(key)) {
+         ensure(count < max_wide_entries);
+         Key keys[max_entries];
+         decode(keys);
+         std::copy(keys, keys + count, wide_keys());
+         encoding = KeyEncoding::PLAIN64;
+      }
+      Pos position = lower_bound(key);
+      track_append(position == end());
+      if (encoding == KeyEncoding::DELTA) {
+         std::move(deltas() + position, deltas() + end(), deltas() + position + 1);
+         deltas()[position] = static_cast<Delta>(key - base());
+      } else {
+         std::move(wide_keys() + position, wide_keys() + end(), wide_keys() + position + 1);
+         wide_keys()[position] = key;
+      }
+      std::move(std::begin(values) + position, std::begin(values) + end(), std::begin(values) + position + 1);
+      values[position] = value;
+      count++;
+   }
+
+   bool update(const Key& key, const Value& value) {
+      Pos position = lower_bound(key);
+      if ((position == end()) || (key_at(position) != key)) return false;
+      values[position] = value;
+      return true;
+   }
+
+   void upsert(const Key& key, const Value& value) {
+      if (update(key, value)) return;
+      insert(key, value);
+   }
+
+   SeparatorInfo<Key> split(NodeID placement = EMPTY_NODEID) {
+      AllocationLatch<BTreeDeltaLeaf> rightNode(placement);
+      auto sepInfo = split_into(rightNode.operator->(), rightNode.remote_ptr);
+      rightNode.unlatch();
+      return sepInfo;
+   }
+   // a leaf can also be split before it is full, i.e., if a far key does not fit the wide encoding
+   SeparatorInfo<Key> split_into(BTreeDeltaLeaf* right, RemotePtr right_ptr) {
+      assert(count > 1);
+      SeparatorInfo<Key> sepInfo;
+      Pos sepPosition = find_separator();
+      right->append_streak = std::exchange(append_streak, static_cast<uint8_t>(0));
+      right->setRightLink(getRightLink());
+      setRightLink(right_ptr);
+      Key keys[max_entries];
+      decode(keys);
+      sepInfo.sep = keys[sepPosition];
+      sepInfo.rightNode = right_ptr;
+      // fences first since they define the base of the encoding; order is important
+      right->fenceKeys.setFences({.isInfinity = false, .key = sepInfo.sep}, fenceKeys.getUpper());
+      fenceKeys.setFences(fenceKeys.getLower(), {.isInfinity = false, .key = sepInfo.sep});
+      auto rightCount = static_cast<Pos>(count - (sepPosition + 1));
+      right->assign(keys + sepPosition + 1, values.data() + sepPosition + 1, rightCount);
+      assign(keys, values.data(), static_cast<Pos>(sepPosition + 1));
+      sepInfo.rightCount = rightCount;
+      return sepInfo;
+   }
+
+   Pos find_separator() { return split_position(); }
+   bool has_space() { return (count < capacity()); }
+   bool has_space_for(const Key& key) {
+      if (encoding == KeyEncoding::DELTA && !fits(key)) return count < max_wide_entries;
+      return has_space();
+   }
+   Pos begin() { return 0; }
+   Pos end() { return count; }
+   Key key_at(Pos idx) { return (encoding == KeyEncoding::DELTA) ? static_cast<Key>(base() + deltas()[idx]) : wide_keys()[idx]; }
+   inline Value value_at(Pos idx) { return values[idx]; }
+   Value* value_slot(Pos idx) { return &values[idx]; }
+   void print_keys() {
+      for (auto idx = begin(); idx < end(); idx++) { std::cout << key_at(idx) << "\n"; }
+   }
+   void print_values() {
+      for (auto idx = begin(); idx < end(); idx++) { std::cout << values[idx] << "\n"; }
+   }
+};
+
+template <LEAF_LAYOUT layout, typename Key, typename Value>
+struct LeafSelector;
+template <typename Key, typename Value>
+struct LeafSelector<LEAF_LAYOUT::PLAIN, Key, Value> {
+   using type = BTreeLeaf<Key, Value>;
+};
+template <typename Key, typename Value>
+struct LeafSelector<LEAF_LAYOUT::RECORDS, Key, Value> {
+   using type = BTreeRecordLeaf<Key, Value>;
+};
+template <typename Key, typename Value>
+struct LeafSelector<LEAF_LAYOUT::FINGERPRINT, Key, Value> {
+   using type = BTreeFPLeaf<Key, Value>;
+};
+template <typename Key, typename Value>
+struct LeafSelector<LEAF_LAYOUT::DELTA16, Key, Value> {
+   using type = BTreeDeltaLeaf<Key, Value, uint16_t>;
+};
+template <typename Key, typename Value>
+struct LeafSelector<LEAF_LAYOUT::DELTA32, Key, Value> {
+   using type = BTreeDeltaLeaf<Key, Value, uint32_t>;
+};
+// leaf layout shared by storage and compute nodes
+template <typename Key, typename Value>
+using ActiveLeaf = typename LeafSelector<ACTIVE_LEAF_LAYOUT, Key, Value>::type;
+
 template <typename Key>
 struct BTreeInner : public BTreeHeader {
    using super = BTreeHeader;
-   static constexpr uint64_t inner_size{
-       (BTREE_NODE_SIZE - sizeof(BTreeHeader) - sizeof(RemotePtr) - sizeof(FenceKeys<Key>))};
-   static constexpr uint64_t max_entries{inner_size / (sizeof(Key) + sizeof(RemotePtr))};
-   static constexpr uint64_t bytes_padding{inner_size - max_entries * (sizeof(Key) + sizeof(Value))};
+   using FillHint = uint8_t;
+   static constexpr uint64_t inner_size{(BTREE_NODE_SIZE - sizeof(BTreeHeader) - sizeof(RemotePtr) -
+                                         sizeof(FillHint) - sizeof(FenceKeys<Key>) -
+                                         MAX_REPLICAS * sizeof(RemotePtr))};
+   static constexpr uint64_t max_entries{inner_size / (sizeof(Key) + sizeof(RemotePtr) + sizeof(FillHint))};
+   static constexpr uint64_t bytes_padding{inner_size -
+                                           max_entries * (sizeof(Key) + sizeof(RemotePtr) + sizeof(FillHint))};
+   static constexpr FillHint UNKNOWN_FILL{0};
+   // copies on further storage nodes if the node is on a replicated level, fixed for the lifetime of the node. Kept in
+   // the node so that a reader learns them with the read it issues anyway; costs one entry of fanout (54 instead of
+   // 55 with 1 KiB nodes and 8 byte keys) even without replication
+   std::array<RemotePtr, MAX_REPLICAS> replicas;
    FenceKeys<Key> fenceKeys;
    std::array<Key, max_entries> sep;
    std::array<RemotePtr, max_entries + 1> children;
+   // last known entry count of the child (only maintained for leaves), used to size the leaf read
+   std::array<FillHint, max_entries + 1> fill_hints;
    uint8_t padding[bytes_padding];
 
    BTreeInner() : BTreeHeader(BTreeNodeType::INNER) {
       static_assert(sizeof(BTreeInner) == BTREE_NODE_SIZE, "btree node size problem");
+      replicas.fill(NULL_REMOTEPTR);
+   }
+
+   bool replicated() { return replicas[0] != NULL_REMOTEPTR; }
+   // allocates the replicas of a new node on the storage nodes following its owner; level must be set
+   void place_replicas(RemotePtr self) {
+      if (FLAGS_replication_level == 0 || level < FLAGS_replication_level) return;
+      auto copies = std::min<uint64_t>(MAX_REPLICAS, FLAGS_storage_nodes - 1);
+      for (uint64_t r_i = 0; r_i < copies; r_i++)
+         replicas[r_i] = threads::onesided::Worker::my().allocate_page((self.getOwner() + 1 + r_i) % FLAGS_storage_nodes);
+   }
+   // initial content of the replicas, must be called on the RDMA copy before the node becomes reachable
+   void write_replicas() {
+      for (auto& replica : replicas) {
+         if (replica == NULL_REMOTEPTR) break;
+         threads::onesided::Worker::my().remote_write<BTreeInner>(replica, this, dtree::rdma::completion::signaled);
+      }
    }
 
    Pos lower_bound(const Key& key) {
@@ -174,42 +722,70 @@ struct BTreeInner : public BTreeHeader {
       return children[pos];
    }
 
-   bool insert(const Key& newSep, const RemotePtr& left, const RemotePtr& right) {
+   bool insert(const Key& newSep, const RemotePtr& left, const RemotePtr& right, FillHint left_fill = UNKNOWN_FILL,
+               FillHint right_fill = UNKNOWN_FILL) {
       Pos position = lower_bound(newSep);
+      track_append(position == end());
       std::move(std::begin(sep) + position, std::begin(sep) + end(), std::begin(sep) + position + 1);
       // end() + 1 handles the n+1 childs
       std::move(std::begin(children) + position, std::begin(children) + end() + 1, std::begin(children) + position + 1);
+      std::move(std::begin(fill_hints) + position, std::begin(fill_hints) + end() + 1,
+                std::begin(fill_hints) + position + 1);
       sep[position] = newSep;
       children[position] = left;
       children[position + 1] = right;  // this updates the old left pointer
+      fill_hints[position] = left_fill;
+      fill_hints[position + 1] = right_fill;
       count++;
       return true;
    }
 
-   SeparatorInfo<Key> split() {
+   // B-link separator insertion: the child covering newSep keeps its slot left of the new separator, which is not
+   // necessarily the node that was split if a further split of it got published first
+   bool insert_link(const Key& newSep, const RemotePtr& right, FillHint right_fill = UNKNOWN_FILL) {
+      Pos position = lower_bound(newSep);
+      RemotePtr left = children[position];
+      FillHint left_fill = fill_hints[position];
+      return insert(newSep, left, right, left_fill, right_fill);
+   }
+
+   SeparatorInfo<Key> split(NodeID placement = EMPTY_NODEID) {
       assert(count == max_entries);  // only split if full
+      AllocationLatch<BTreeInner> rightNode(placement);
+      auto sepInfo = split_into(rightNode.operator->(), rightNode.remote_ptr);
+      rightNode->place_replicas(rightNode.remote_ptr);
+      rightNode->write_replicas();
+      rightNode.unlatch();
+      return sepInfo;
+   }
+   SeparatorInfo<Key> split_into(BTreeInner* right, RemotePtr right_ptr) {
+      assert(count > 1);
       SeparatorInfo<Key> sepInfo;
-      AllocationLatch<BTreeInner> rightNode;
+      right->level = level;
       auto sepPosition = find_separator();
+      right->append_streak = std::exchange(append_streak, static_cast<uint8_t>(0));
+      right->setRightLink(getRightLink());
+      setRightLink(right_ptr);
       sepInfo.sep = sep[sepPosition];
-      sepInfo.rightNode = rightNode.remote_ptr;
+      sepInfo.rightNode = right_ptr;
       // move from one node to the other; keep separator key in the left child
-      std::move(std::begin(sep) + sepPosition + 1, std::begin(sep) + end(), std::begin(rightNode->sep));
+      std::move(std::begin(sep) + sepPosition + 1, std::begin(sep) + end(), std::begin(right->sep));
       // need to copy one more
       std::move(std::begin(children) + sepPosition + 1, std::begin(children) + end() + 1,
-                std::begin(rightNode->children));
+                std::begin(right->children));
+      std::move(std::begin(fill_hints) + sepPosition + 1, std::begin(fill_hints) + end() + 1,
+                std::begin(right->fill_hints));
       // update counts
-      rightNode->count = count - static_cast<Pos>((sepPosition + 1));
-      count = static_cast<Pos>(count - static_cast<Pos>(rightNode->count) - static_cast<Pos>(1));  // -1 removes the sep key but ptr is kept
+      right->count = count - static_cast<Pos>((sepPosition + 1));
+      count = static_cast<Pos>(count - static_cast<Pos>(right->count) - static_cast<Pos>(1));  // -1 removes the sep key but ptr is kept
       // set fences
-      rightNode->fenceKeys.setFences({.isInfinity = false, .key = sepInfo.sep},
-                                     fenceKeys.getUpper());  // order is important
+      right->fenceKeys.setFences({.isInfinity = false, .key = sepInfo.sep},
+                                 fenceKeys.getUpper());  // order is important
       fenceKeys.setFences(fenceKeys.getLower(), {.isInfinity = false, .key = sepInfo.sep});
-      rightNode.unlatch();
       return sepInfo;
    }
 
-   Pos find_separator() { return count / 2; }
+   Pos find_separator() { return split_position(); }
    bool has_space() { return (count < max_entries); }
    Pos begin() { return 0; }
    Pos end() { return count; }  // returns one it behind valid it as usual
@@ -237,51 +813,382 @@ struct NodePlaceholder : public BTreeHeader {
    BTreeHeader* operator->() { return static_cast<BTreeHeader*>(this); }
 };
 
-// client driven
-template <typename Key, typename Value>
+inline AllocationPolicy parse_allocation_policy(std::string_view name) {
+   if (name == "random") return AllocationPolicy::RANDOM;
+   if (name == "sibling") return AllocationPolicy::SIBLING;
+   if (name == "parent") return AllocationPolicy::PARENT;
+   if (name == "round_robin") return AllocationPolicy::ROUND_ROBIN;
+   if (name == "least_loaded") return AllocationPolicy::LEAST_LOADED;
+   throw std::invalid_argument("unknown allocation policy");
+}
+// -------------------------------------------------------------------------------------
+// root pointer of a tree cached per compute node and shared by its workers, it spares the read of the metadata page
+// which every traversal would otherwise issue against the same remote cache line. The cached pointer is only a hint:
+// the root is the only node with two infinite fences, a split of it makes the upper fence finite
+struct RootCache {
+   std::atomic<uint64_t> root{NULL_REMOTEPTR.offset};
+   static RootCache& of(RemotePtr metadata) {
+      static std::mutex mutex;
+      static std::unordered_map<uint64_t, std::unique_ptr<RootCache>> caches;
+      std::unique_lock<std::mutex> guard(mutex);
+      auto& cache = caches[metadata.offset];
+      if (!cache) cache = std::make_unique<RootCache>();
+      return *cache;
+   }
+};
+
+// replica pointers of inner nodes, learned per compute node when a replicated primary is read. Writers of a slot are
+// serialized and bump the sequence around the update, readers that observe a change fall back to the primary
+struct ReplicaDirectory {
+   static constexpr uint64_t SLOTS{4096};
+   struct Slot {
+      std::atomic<uint64_t> sequence{0};  // odd while the slot is written
+      std::atomic<uint64_t> primary{NULL_REMOTEPTR.offset};
+      std::array<std::atomic<uint64_t>, MAX_REPLICAS> replicas{};
+   };
+   std::array<Slot, SLOTS> slots;
+   std::mutex writer;
+
+   static ReplicaDirectory& instance() {
+      static ReplicaDirectory directory;
+      return directory;
+   }
+   Slot& slot(RemotePtr primary) { return slots[(primary.plainOffset() / BTREE_NODE_SIZE + primary.getOwner()) % SLOTS]; }
+   bool known(RemotePtr primary) { return slot(primary).primary.load() == primary.offset; }
+   void record(RemotePtr primary, const std::array<RemotePtr, MAX_REPLICAS>& replicas) {
+      std::unique_lock<std::mutex> guard(writer);
+      auto& s = slot(primary);
+      s.sequence++;
+      s.primary.store(primary.offset);
+      for (size_t r_i = 0; r_i < MAX_REPLICAS; r_i++) s.replicas[r_i].store(replicas[r_i].offset);
+      s.sequence++;
+   }
+   // statically spreads the workers of all compute nodes over the primary and its replicas
+   RemotePtr pick(RemotePtr primary) {
+      auto& s = slot(primary);
+      auto sequence = s.sequence.load();
+      if ((sequence & 1) || s.primary.load() != primary.offset) return primary;
+      std::array<RemotePtr, MAX_REPLICAS + 1> copies;
+      uint64_t count = 0;
+      copies[count++] = primary;
+      for (auto& replica : s.replicas) {
+         RemotePtr r(replica.load());
+         if (r != NULL_REMOTEPTR) copies[count++] = r;
+      }
+      if (s.sequence.load() != sequence) return primary;
+      auto& worker = threads::onesided::Worker::my();
+      return copies[(worker.workerId + worker.nodeId_ * FLAGS_worker) % count];
+   }
+};
+
+// fill hints found too small, shared by the workers of a compute node: the leaf is read in full with one READ as long
+// as its parent still announces the same hint, instead of a prefix READ that is always followed by a READ of the tail.
+// Direct mapped; entries are advisory, hence a torn or evicted entry only costs one more truncated read
+struct StaleHints {
+   struct Entry {
+      std::atomic<uint64_t> leaf{0};
+      std::atomic<uint8_t> hint{0};
+   };
+   std::array<Entry, STALE_HINT_SLOTS> entries;
+
+   static StaleHints& instance() {
+      static StaleHints hints;
+      return hints;
+   }
+   Entry& slot(RemotePtr leaf) {
+      return entries[(leaf.plainOffset() / BTREE_NODE_SIZE + leaf.getOwner()) % STALE_HINT_SLOTS];
+   }
+   bool known(RemotePtr leaf, uint8_t hint) {
+      auto& e = slot(leaf);
+      return e.leaf.load(std::memory_order_relaxed) == leaf.offset && e.hint.load(std::memory_order_relaxed) == hint;
+   }
+   void remember(RemotePtr leaf, uint8_t hint) {
+      auto& e = slot(leaf);
+      e.hint.store(hint, std::memory_order_relaxed);
+      e.leaf.store(leaf.offset, std::memory_order_relaxed);
+   }
+};
+
+// client driven; LatchPolicy decides how lookups and ascending scans read leaves (see OneSidedLatches.hpp), inner
+// nodes are always read optimistically and writers always latch exclusively
+template <typename Key, typename Value, typename LeafT = ActiveLeaf<Key, Value>, typename LatchPolicy = OptimisticReads>
 struct BTree {
-   using Leaf = BTreeLeaf<Key, Value>;
+   using KeyType = Key;
+   using ValueType = Value;
+   using Leaf = LeafT;
+   using LeafGuard = typename LatchPolicy::template ReadGuard<NodePlaceholder>;
    using Inner = BTreeInner<Key>;
    using SepInfo = SeparatorInfo<Key>;
+   using FillHint = typename Inner::FillHint;
+   static_assert(Leaf::max_entries <= std::numeric_limits<FillHint>::max(), "fill hint too small");
+   // hints overestimate the leaf count slightly so that a few inserts do not force a second read
+   static constexpr Pos FILL_HINT_SLACK{8};
    RemotePtr metadata;
-   BTree(RemotePtr metadata) : metadata(metadata) {}
+   RootCache& root_cache;
+   NodeID placement;  // storage node of all new nodes, EMPTY_NODEID leaves the choice to the policy
+   AllocationPolicy policy;
+   BTree(RemotePtr metadata, NodeID placement = EMPTY_NODEID,
+         AllocationPolicy policy = parse_allocation_policy(FLAGS_allocation_policy))
+       : metadata(metadata), root_cache(RootCache::of(metadata)), placement(placement), policy(policy) {}
+
+   // storage node of the right half when node is split below parent
+   NodeID place(RemotePtr node, RemotePtr parent) {
+      if (placement != EMPTY_NODEID) return placement;
+      return threads::onesided::Worker::my().place(policy, node, parent);
+   }
+
+   static FillHint fill_hint(Pos entries) {
+      if constexpr (!Leaf::truncated_reads) return Inner::UNKNOWN_FILL;
+      return static_cast<FillHint>(std::min<uint64_t>(entries + FILL_HINT_SLACK, Leaf::max_entries));
+   }
+   // bytes of the leaf below parent at idx to read first: the prefix announced by the fill hint or, if the hint is
+   // unknown or already found stale, the whole leaf
+   static uint64_t leaf_read_size(Inner* parent, Pos idx) {
+      auto hint = parent->fill_hints[idx];
+      if (!Leaf::truncated_reads || hint == Inner::UNKNOWN_FILL) return sizeof(Leaf);
+      if (StaleHints::instance().known(parent->children[idx], hint)) return sizeof(Leaf);
+      return Leaf::bytes_for(hint);
+   }
+   // the prefix read of the leaf below parent at idx ended before its entries; remembers the hint as stale
+   static void hint_was_stale(Inner* parent, Pos idx) {
+      StaleHints::instance().remember(parent->children[idx], parent->fill_hints[idx]);
+   }
+   // reads only the prefix of the leaf announced by the parent's fill hint; a stale hint fetches the tail once and
+   // makes the following reads of the leaf full reads until the parent announces a new hint
+   template <typename Guard = GuardO<NodePlaceholder>>
+   Guard read_leaf(Inner* parent, Pos idx) {
+      auto& counters = threads::onesided::Worker::my().counters;
+      auto bytes = leaf_read_size(parent, idx);
+      counters.incr(profiling::WorkerCounters::leaf_reads);
+      if (bytes == sizeof(Leaf)) {
+         counters.incr_by(profiling::WorkerCounters::leaf_read_bytes, bytes);
+         return Guard(parent->children[idx]);
+      }
+      Guard leaf(parent->children[idx], bytes);
+      auto needed = Leaf::bytes_for(leaf->count);
+      if (needed > bytes) {
+         hint_was_stale(parent, idx);
+         leaf.fetch(bytes, needed - bytes);
+         counters.incr(profiling::WorkerCounters::leaf_reads);
+         bytes = needed;
+      }
+      counters.incr_by(profiling::WorkerCounters::leaf_read_bytes, bytes);
+      return leaf;
+   }
+   static bool is_root(GuardO<NodePlaceholder>& node) {
+      auto fences = (node->getNodeType() == BTreeNodeType::INNER) ? node->as<Inner>()->fenceKeys
+                                                                  : node->as<Leaf>()->fenceKeys;
+      return fences.isLowerInfinity() && fences.isUpperInfinity();
+   }
+   // the node is validated by the traversal like any other node read
+   // read-only traversals spread the reads of replicated inner nodes over all copies, writers latch primaries only
+   GuardO<NodePlaceholder> read_node(RemotePtr primary) {
+      if (FLAGS_replication_level == 0) return GuardO<NodePlaceholder>(primary);
+      auto& directory = ReplicaDirectory::instance();
+      auto copy = directory.pick(primary);
+      GuardO<NodePlaceholder> node(copy);
+      if (copy == primary && node->getNodeType() == BTreeNodeType::INNER && node->as<Inner>()->replicated() &&
+          !directory.known(primary)) {
+         auto replicas = node->as<Inner>()->replicas;
+         node.checkVersionAndRestart();  // pointers of a torn read must not be recorded
+         directory.record(primary, replicas);
+      }
+      return node;
+   }
+   // exclusive latches on the replicas of a latched primary. They are taken before anything below the primary changes,
+   // hence readers of a replica restart like readers of the primary; apply() copies the final state of the primary
+   struct ReplicaLatches {
+      std::array<RemotePtr, MAX_REPLICAS> replicas;
+      explicit ReplicaLatches(GuardX<NodePlaceholder>& primary) {
+         replicas.fill(NULL_REMOTEPTR);
+         if (primary->getNodeType() != BTreeNodeType::INNER) return;
+         replicas = primary->as<Inner>()->replicas;
+         auto& worker = threads::onesided::Worker::my();
+         for (auto& replica : replicas) {
+            if (replica == NULL_REMOTEPTR) break;
+            while (!worker.compareSwap(UNLOCKED, EXCLUSIVE_LOCKED, replica, dtree::rdma::completion::signaled,
+                                       worker.barrier_buffer))
+               _mm_pause();
+         }
+      }
+      // the latch word of the replicas is left out like in ExclusiveLatch::unlatch
+      void apply(GuardX<NodePlaceholder>& primary) {
+         primary->version = primary.latch.version + 1;  // the version the primary gets on unlatch
+         for (auto& replica : replicas) {
+            if (replica == NULL_REMOTEPTR) break;
+            threads::onesided::Worker::my().remote_write_range(replica, primary.operator->(), sizeof(uint64_t),
+                                                               sizeof(NodePlaceholder) - sizeof(uint64_t));
+         }
+      }
+      // runs while unwinding from restarts, hence releases without checks
+      ~ReplicaLatches() { unlatch(); }
+      void unlatch() {
+         auto& worker = threads::onesided::Worker::my();
+         for (auto& replica : replicas) {
+            if (replica == NULL_REMOTEPTR) break;
+            worker.fetchAdd(EXCLUSIVE_UNLOCK_TO_BE_ADDED, replica, dtree::rdma::completion::signaled,
+                            worker.barrier_buffer);
+         }
+         replicas.fill(NULL_REMOTEPTR);
+      }
+   };
+   // any_copy: read-only traversals may use a replica of the root
+   GuardO<NodePlaceholder> read_root(bool any_copy = false) {
+      RemotePtr cached(root_cache.root.load());
+      if (cached != NULL_REMOTEPTR) {
+         GuardO<NodePlaceholder> node(any_copy ? read_node(cached) : GuardO<NodePlaceholder>(cached));
+         if (is_root(node)) return node;
+      }
+      GuardO<MetadataPage> g_metadata(metadata);
+      auto root = g_metadata->getRootPtr();
+      g_metadata.release();
+      root_cache.root.store(root.offset);
+      return GuardO<NodePlaceholder>(root);
+   }
    // insert
-   void make_new_root(GuardX<MetadataPage>& parent, Key separator, RemotePtr left, RemotePtr right) {
-      AllocationLatch<Inner> new_root;
-      new_root->insert(separator, left, right);
+   void make_new_root(GuardX<MetadataPage>& parent, Key separator, RemotePtr left, RemotePtr right, uint8_t level,
+                      FillHint left_fill = Inner::UNKNOWN_FILL, FillHint right_fill = Inner::UNKNOWN_FILL) {
+      AllocationLatch<Inner> new_root(place(left, NULL_REMOTEPTR));
+      new_root->insert(separator, left, right, left_fill, right_fill);
+      new_root->level = level;
+      new_root->place_replicas(new_root.remote_ptr);
+      new_root->write_replicas();
       parent->setRootPtr(new_root.remote_ptr);
-      parent->setHeight(parent->getHeight());
+      parent->setHeight(level + 1u);
       new_root.unlatch();
+      root_cache.root.store(new_root.remote_ptr.offset);
    }
    // helper functions for range scan
+   // entries of a leaf are staged and only handed out after the leaf and its parent validated; the last delivered
+   // key is the checkpoint from which a restarted scan resumes with an exclusive lower bound
+   template <typename FN>
+   struct ScanState {
+      FN& scan_function;
+      const Key from;
+      const Key to;
+      bool delivered_any{false};
+      Key last_delivered{};
+      std::array<std::pair<Key, Value>, Leaf::max_entries> staged{};
+      Pos staged_count{0};
+
+      Key resume_key() const { return delivered_any ? last_delivered : from; }
+      // returns true if the leaf contains a key beyond the scan range
+      bool stage(Leaf* leaf) {
+         staged_count = 0;
+         for (Pos it = leaf->lower_bound(resume_key()); it != leaf->end(); it++) {
+            auto c_key = leaf->key_at(it);
+            if (c_key > to) return true;  // scan finished
+            if (delivered_any && c_key <= last_delivered) continue;
+            staged[staged_count++] = {c_key, leaf->value_at(it)};
+         }
+         return false;  // continue to scan
+      }
+      void deliver() {
+         for (Pos s_i = 0; s_i < staged_count; s_i++) {
+            // checkpoint first: a restart thrown by the callback must not deliver the entry again
+            last_delivered = staged[s_i].first;
+            delivered_any = true;
+            scan_function(staged[s_i].first, staged[s_i].second);
+         }
+         staged_count = 0;
+      }
+   };
+   // stages the leaf, validates leaf and parent and delivers; returns true if the scan is finished
+   template <typename FN>
+   bool scan_leaf(LeafGuard& leaf, GuardO<NodePlaceholder>& parent, ScanState<FN>& state) {
+      auto finished = state.stage(leaf->template as<Leaf>());
+      finished |= leaf->template as<Leaf>()->fenceKeys.getUpper().isInfinity;
+      leaf.release();
+      parent.checkVersionAndRestart();
+      state.deliver();
+      return finished;
+   }
+
+   // number of children from idx on that lie back to back on one storage node, at most limit
+   static Pos contiguous_run(Inner* inner, Pos idx, Pos limit) {
+      Pos run = 1;
+      while (run < limit && idx + run <= inner->end() &&
+             inner->children[idx + run].offset == inner->children[idx + run - 1].offset + BTREE_NODE_SIZE)
+         run++;
+      return run;
+   }
+   // the run of leaves [idx, idx + run) is fetched with a single READ and validated with one batch of header reads,
+   // instead of two round trips per leaf; returns true if the scan is finished
+   template <typename FN>
+   bool scan_leaf_run(GuardO<NodePlaceholder>& parent, Pos idx, Pos run, ScanState<FN>& state) {
+      static_assert(MAX_READ_BATCH * BTREE_NODE_SIZE <= threads::onesided::Worker::BATCH_BUFFER_BYTES,
+                    "a run must fit into the batch buffer");
+      auto& worker = threads::onesided::Worker::my();
+      auto first = parent->as<Inner>()->children[idx];
+      auto leaves = static_cast<size_t>(run);
+      auto leaf_at = [&](size_t l_i) {
+         return static_cast<Leaf*>(static_cast<void*>(worker.batch_buffer + (l_i * BTREE_NODE_SIZE)));
+      };
+      std::array<threads::onesided::Worker::ReadRequest, MAX_READ_BATCH> reads;
+      reads[0] = {first, worker.batch_buffer, leaves * BTREE_NODE_SIZE};
+      worker.read_batch(reads.data(), 1);
+      std::array<Version, MAX_READ_BATCH> versions;
+      for (size_t l_i = 0; l_i < leaves; l_i++) {
+         if (exclusively_latched(leaf_at(l_i)->remote_latch)) throw OLCRestartException();
+         versions[l_i] = leaf_at(l_i)->version;
+         reads[l_i] = {RemotePtr(first.offset + (l_i * BTREE_NODE_SIZE)), worker.batch_header(l_i), sizeof(PageHeader)};
+      }
+      worker.read_batch(reads.data(), leaves);
+      for (size_t l_i = 0; l_i < leaves; l_i++) {
+         auto* header = worker.batch_header(l_i);
+         if (exclusively_latched(header->remote_latch) || header->version != versions[l_i])
+            throw OLCRestartException();
+      }
+      parent.checkVersionAndRestart();
+      for (size_t l_i = 0; l_i < leaves; l_i++) {
+         auto finished = state.stage(leaf_at(l_i));
+         finished |= leaf_at(l_i)->fenceKeys.getUpper().isInfinity;
+         state.deliver();
+         if (finished) return true;
+      }
+      return false;
+   }
+   // scans the children of the level 1 parent from it_inner on; returns true if the scan is finished
+   template <typename FN>
+   bool scan_children(GuardO<NodePlaceholder>& parent, Pos it_inner, ScanState<FN>& state) {
+      while (it_inner <= parent->as<Inner>()->end()) {
+         auto run = contiguous_run(parent->as<Inner>(), it_inner, static_cast<Pos>(MAX_READ_BATCH));
+         if (run > 1 && LatchPolicy::optimistic) {  // runs are read without latches
+            if (scan_leaf_run(parent, it_inner, run, state)) return true;
+            it_inner = static_cast<Pos>(it_inner + run);
+            continue;
+         }
+         // fetch new leaf
+         LeafGuard leaf(read_leaf<LeafGuard>(parent->as<Inner>(), it_inner));
+         if (scan_leaf(leaf, parent, state)) return true;
+         it_inner++;
+      }
+      return false;
+   }
+
    template <typename FN>
    std::pair<bool, Key> initial_traversal(const Key& moving_start,
-                                          FN iterate_leaf) {  // find first inner node with lower bound search
-      GuardO<MetadataPage> g_metadata(metadata);
+                                          ScanState<FN>& state) {  // find first inner node with lower bound search
       GuardO<NodePlaceholder> parent;
-      GuardO<NodePlaceholder> node(g_metadata->getRootPtr());
-      g_metadata.checkVersionAndRestart();
+      GuardO<NodePlaceholder> node(read_root(true));
       while (node->getNodeType() == BTreeNodeType::INNER) {
          parent = std::move(node);
-         node = GuardO<NodePlaceholder>(parent->as<Inner>()->next_child(moving_start));
+         node = read_node(parent->as<Inner>()->next_child(moving_start));
          parent.checkVersionAndRestart();
       }
       // handle edge case of root == leaf
       if (parent.not_used()) {
          ensure(node->getNodeType() == BTreeNodeType::LEAF);
-         iterate_leaf(node->as<Leaf>());
+         state.stage(node->as<Leaf>());
+         node.release();
+         state.deliver();
          return {true, moving_start};  // finished scan
       }
       node.release();
       // parent can be used to prefetch should be inner node
       Pos it_inner = parent->as<Inner>()->lower_bound(moving_start);
       // iterate inner and get all leafes
-      for (; it_inner <= parent->as<Inner>()->end(); it_inner++) {
-         GuardO<NodePlaceholder> leaf(parent->as<Inner>()->value_at(it_inner));
-         auto finished = iterate_leaf(leaf->as<Leaf>());
-         if (finished || leaf->as<Leaf>()->fenceKeys.getUpper().isInfinity)
-            return {true, moving_start};  // finished scan
-      }
+      if (scan_children(parent, it_inner, state)) return {true, moving_start};  // finished scan
       // continue to scan with adjusted search method;
       return {false, parent->as<Inner>()->fenceKeys.getUpper().key};  // finished scan
    }
@@ -289,15 +1196,13 @@ struct BTree {
    // uses upper bound traversal to steer the scan
    template <typename FN>
    std::pair<bool, Key> consecutive_traversal(const Key& moving_start,
-                                              FN iterate_leaf) {  // find first inner node with lower bound search
-      GuardO<MetadataPage> g_metadata(metadata);
+                                              ScanState<FN>& state) {  // find first inner node with lower bound search
       GuardO<NodePlaceholder> parent;
-      GuardO<NodePlaceholder> node(g_metadata->getRootPtr());
-      g_metadata.checkVersionAndRestart();
+      GuardO<NodePlaceholder> node(read_root(true));
       while (node->getNodeType() == BTreeNodeType::INNER) {
          parent = std::move(node);
          auto idx = parent->as<Inner>()->upper_bound(moving_start);
-         node = GuardO<NodePlaceholder>(parent->as<Inner>()->children[idx]);
+         node = read_node(parent->as<Inner>()->children[idx]);
          parent.checkVersionAndRestart();
       }
       node.release();
@@ -305,61 +1210,226 @@ struct BTree {
       auto new_start = parent->as<Inner>()->fenceKeys.getLower().key;
       Pos it_inner = parent->as<Inner>()->lower_bound(new_start);
       // iterate inner and get all leafes
-      for (; it_inner <= parent->as<Inner>()->end(); it_inner++) {
-         // fetch new leaf
-         GuardO<NodePlaceholder> leaf(parent->as<Inner>()->value_at(it_inner));
-         auto finished = iterate_leaf(leaf->as<Leaf>());
-         if (finished || leaf->as<Leaf>()->fenceKeys.getUpper().isInfinity)
-            return {true, moving_start};  // finished scan
-      }
+      if (scan_children(parent, it_inner, state)) return {true, moving_start};  // finished scan
       // continue to scan with adjusted search method;
       return {false, parent->as<Inner>()->fenceKeys.getUpper().key};  // finished scan
    }
-   // this function scans one inner node and returns
+   // delivers every key in [from, to] exactly once and in order; a conflict resumes after the last delivered key
+   // instead of starting over. scan_function may throw OLCRestartException itself
    template <typename FN>
-   void range_scan(const Key from, const Key to, FN scan_function, std::function<void()> undo) {
-      [[maybe_unused]] bool first_traversal = true;  // need to use lower_bound search
-      [[maybe_unused]] bool scan_finished = false;   // need to use lower_bound search
-      auto moving_start = from;                      // is used to steer the scan
-      auto iterate_leaf = [&](Leaf* leaf) -> bool {
-         for (Pos it = leaf->lower_bound(moving_start); it != leaf->end(); it++) {
-            auto c_key = leaf->key_at(it);
-            if (c_key > to) return true;  // scan finished
-            scan_function(c_key, leaf->value_at(it));
-            moving_start = c_key;
-         }
-         return false;  // continue to scan
-      };
+   void range_scan(const Key from, const Key to, FN scan_function) {
+      bool first_traversal = true;  // need to use lower_bound search
+      bool scan_finished = false;
+      auto moving_start = from;  // is used to steer the scan
+      ScanState<FN> state{scan_function, from, to};
       for ([[maybe_unused]] size_t repeat = 0;; repeat++) {
          try {
             if (first_traversal)
-               std::tie(scan_finished, moving_start) = initial_traversal(moving_start, iterate_leaf);
+               std::tie(scan_finished, moving_start) = initial_traversal(moving_start, state);
             else if (!scan_finished) {
-               std::tie(scan_finished, moving_start) = consecutive_traversal(moving_start, iterate_leaf);
+               std::tie(scan_finished, moving_start) = consecutive_traversal(moving_start, state);
             } else
                return;
             first_traversal = false;
          } catch (const OLCRestartException&) {
             ensure(threads::onesided::Worker::my().local_rmemory.get_size() == CONCURRENT_LATCHES);
-            // restart at the beginning 
-            moving_start = from; 
+            // resume at the checkpoint
+            moving_start = state.resume_key();
             first_traversal = true;
             scan_finished = false;
-            undo();
          }
       }
    }
 
+   // helper for descending scans: reads the children [begin, end) of the latched inner node with one doorbell batch and
+   // stages them from right to left; returns true if a key below the scan range was found
+   template <typename STAGE>
+   bool stage_leaf_batch(GuardO<NodePlaceholder>& inner_guard, Pos begin, Pos end, STAGE&& stage) {
+      auto& worker = threads::onesided::Worker::my();
+      auto* inner = inner_guard->as<Inner>();
+      ensure(end - begin <= static_cast<int>(MAX_READ_BATCH));
+      std::array<threads::onesided::Worker::ReadRequest, MAX_READ_BATCH> reads;
+      size_t batch = static_cast<size_t>(end - begin);
+      for (size_t b_i = 0; b_i < batch; b_i++) {
+         auto idx = static_cast<Pos>(end - 1 - b_i);
+         reads[b_i] = {inner->children[idx], worker.batch_node(b_i), leaf_read_size(inner, idx)};
+      }
+      worker.read_batch(reads.data(), batch);
+      worker.counters.incr_by(profiling::WorkerCounters::leaf_reads, batch);
+      for (size_t b_i = 0; b_i < batch; b_i++)
+         worker.counters.incr_by(profiling::WorkerCounters::leaf_read_bytes, reads[b_i].bytes);
+      bool finished = false;
+      size_t staged_leaves = 0;
+      while (staged_leaves < batch && !finished) {
+         auto* leaf = static_cast<Leaf*>(static_cast<void*>(worker.batch_node(staged_leaves)));
+         if (exclusively_latched(leaf->remote_latch)) throw OLCRestartException();
+         auto needed = Leaf::bytes_for(leaf->count);
+         if (needed > reads[staged_leaves].bytes) {
+            hint_was_stale(inner, static_cast<Pos>(end - 1 - staged_leaves));
+            worker.remote_read_range(reads[staged_leaves].remote_ptr, leaf, reads[staged_leaves].bytes,
+                                     needed - reads[staged_leaves].bytes);
+            worker.counters.incr(profiling::WorkerCounters::leaf_reads);
+            worker.counters.incr_by(profiling::WorkerCounters::leaf_read_bytes, needed - reads[staged_leaves].bytes);
+         }
+         finished = stage(leaf);
+         staged_leaves++;
+      }
+      // validate the staged leaves with a second batch that only reads their headers
+      std::array<Version, MAX_READ_BATCH> versions;
+      for (size_t b_i = 0; b_i < staged_leaves; b_i++) {
+         versions[b_i] = static_cast<PageHeader*>(static_cast<void*>(worker.batch_node(b_i)))->version;
+         reads[b_i] = {reads[b_i].remote_ptr, worker.batch_header(b_i), sizeof(PageHeader)};
+      }
+      worker.read_batch(reads.data(), staged_leaves);
+      for (size_t b_i = 0; b_i < staged_leaves; b_i++) {
+         auto* header = worker.batch_header(b_i);
+         if (exclusively_latched(header->remote_latch) || header->version != versions[b_i])
+            throw OLCRestartException();
+      }
+      inner_guard.checkVersionAndRestart();
+      return finished;
+   }
+
+   // delivers every key in [to, from] exactly once in descending order (from >= to). The leaves of an inner node are
+   // read right to left MAX_READ_BATCH at a time, a finished inner node continues at the leaf holding its lower
+   // fence. A conflict resumes below the last delivered key
+   template <typename FN>
+   void range_scan_desc(const Key from, const Key to, FN scan_function) {
+      bool delivered_any = false;
+      Key last_delivered{};
+      Key position = from;  // is used to steer the scan
+      std::vector<std::pair<Key, Value>> staged;
+      staged.reserve(MAX_READ_BATCH * Leaf::max_entries);
+      auto stage = [&](Leaf* leaf) -> bool {
+         Key high = delivered_any ? last_delivered : from;
+         Pos end_it = leaf->lower_bound(high);
+         if (!delivered_any && end_it < leaf->end() && leaf->key_at(end_it) == high) end_it++;
+         for (Pos it = end_it; it-- > 0;) {
+            auto c_key = leaf->key_at(it);
+            if (c_key < to) return true;  // scan finished
+            staged.push_back({c_key, leaf->value_at(it)});
+         }
+         return false;  // continue to scan
+      };
+      auto deliver = [&]() {
+         for (auto& [key, value] : staged) {
+            last_delivered = key;
+            delivered_any = true;
+            scan_function(key, value);
+         }
+         staged.clear();
+      };
+      for ([[maybe_unused]] size_t repeat = 0;; repeat++) {
+         try {
+            staged.clear();
+            GuardO<NodePlaceholder> parent;
+            GuardO<NodePlaceholder> node(read_root(true));
+            while (node->getNodeType() == BTreeNodeType::INNER && node->level > 1) {
+               parent = std::move(node);
+               node = read_node(parent->as<Inner>()->next_child(position));
+               parent.checkVersionAndRestart();
+            }
+            parent.release();
+            // handle edge case of root == leaf
+            if (node->getNodeType() == BTreeNodeType::LEAF) {
+               stage(node->as<Leaf>());
+               node.release();
+               deliver();
+               return;
+            }
+            auto* inner = node->as<Inner>();
+            bool finished = false;
+            // children left of the one covering to only hold smaller keys and are not read
+            auto first = inner->lower_bound(to);
+            for (Pos end = static_cast<Pos>(inner->lower_bound(position) + 1); end > first && !finished;) {
+               auto begin = static_cast<Pos>(std::max<int>(first, end - static_cast<int>(MAX_READ_BATCH)));
+               finished = stage_leaf_batch(node, begin, end, stage);
+               deliver();
+               end = begin;
+            }
+            finished |= first > 0;
+            auto lower = inner->fenceKeys.getLower();
+            node.release();
+            if (finished || lower.isInfinity) return;
+            position = lower.key;  // the left neighbour holds the lower fence
+         } catch (const OLCRestartException&) {
+            ensure(threads::onesided::Worker::my().local_rmemory.get_size() == CONCURRENT_LATCHES);
+            // resume at the checkpoint
+            position = delivered_any ? last_delivered : from;
+         }
+      }
+   }
+
+   // hands the leaf holding the first key >= seek (> seek if exclusive) to consume; consume sees an unvalidated copy
+   // and is repeated after a restart, it must only publish its results once the function returns
+   template <typename FN>
+   void with_leaf(const Key& seek, bool exclusive, FN consume) {
+      for ([[maybe_unused]] size_t repeat = 0;; repeat++) {
+         try {
+            GuardO<NodePlaceholder> parent;
+            GuardO<NodePlaceholder> node(read_root(true));
+            while (node->getNodeType() == BTreeNodeType::INNER) {
+               parent = std::move(node);
+               auto* inner = parent->as<Inner>();
+               auto idx = exclusive ? inner->upper_bound(seek) : inner->lower_bound(seek);
+               if (inner->level == 1) {
+                  GuardO<NodePlaceholder> leaf(read_leaf(inner, idx));
+                  consume(leaf->as<Leaf>());
+                  leaf.release();
+                  parent.checkVersionAndRestart();
+                  return;
+               }
+               node = read_node(inner->children[idx]);
+               parent.checkVersionAndRestart();
+            }
+            consume(node->as<Leaf>());
+            node.release();
+            return;
+         } catch (const OLCRestartException&) {
+            ensure(threads::onesided::Worker::my().local_rmemory.get_size() == CONCURRENT_LATCHES);
+         }
+      }
+   }
+
+   // --split_hints: a node announces itself to the split daemon when an insert leaves SPLIT_HINT_SLACK free entries
+   template <typename T>
+   static bool fills_up(Pos count) {
+      return FLAGS_split_hints && count + SPLIT_HINT_SLACK == T::max_entries;
+   }
+   static void post_split_hint(SplitHint& hint) {
+      if (hint.node == 0) return;
+      threads::onesided::Worker::my().post_split_hint(RemotePtr(hint.parent), RemotePtr(hint.node));
+      hint = {};
+   }
    bool lookup(Key key, Value& retValue) {
       for ([[maybe_unused]] size_t repeat = 0;; repeat++) {
          try {
-            GuardO<MetadataPage> g_metadata(metadata);
             GuardO<NodePlaceholder> parent;
-            GuardO<NodePlaceholder> node(g_metadata->getRootPtr());
-            g_metadata.checkVersionAndRestart();
+            GuardO<NodePlaceholder> node(read_root(true));
             while (node->getNodeType() == BTreeNodeType::INNER) {
+               if (node->level == 1) {
+                  parent = std::move(node);
+                  if constexpr (Leaf::partial_reads) {
+                     // read only header and fingerprints of the leaf, records are fetched on a match
+                     LeafGuard leaf(parent->as<Inner>()->next_child(key), Leaf::header_bytes);
+                     parent.checkVersionAndRestart();
+                     return leaf->template as<Leaf>()->lookup_partial(
+                         key, retValue, [&](uint64_t offset, uint64_t bytes) { leaf.fetch(offset, bytes); });
+                  } else {
+                     auto* inner = parent->as<Inner>();
+                     auto idx = inner->lower_bound(key);
+                     if constexpr (LatchPolicy::optimistic) {
+                        if (auto found = cached_lookup(parent, inner->children[idx], key, retValue)) return *found;
+                     }
+                     LeafGuard leaf(read_leaf<LeafGuard>(inner, idx));
+                     parent.checkVersionAndRestart();
+                     auto found = leaf->template as<Leaf>()->lookup(key, retValue);
+                     if constexpr (LatchPolicy::optimistic) offer_to_cache(leaf, inner->children[idx]);
+                     return found;
+                  }
+               }
                parent = std::move(node);
-               node = GuardO<NodePlaceholder>(parent->as<Inner>()->next_child(key));
+               node = read_node(parent->as<Inner>()->next_child(key));
                parent.checkVersionAndRestart();
             }
             GuardO<NodePlaceholder> leaf(std::move(node));
@@ -370,58 +1440,364 @@ struct BTree {
       }
    }
 
+   //=== leaf cache ===//
+   // --leaf_cache_mb: a lookup is answered from the cached copy of the leaf if the header of the leaf is unchanged.
+   // Layouts with partial reads are not cached, their lookups read little more than the header anyway
+   std::optional<bool> cached_lookup(GuardO<NodePlaceholder>& parent, RemotePtr page, const Key& key, Value& retValue) {
+      auto& cache = LeafCache::local();
+      if (!cache.enabled()) return std::nullopt;
+      auto& worker = threads::onesided::Worker::my();
+      auto* copy = cache.find(page);
+      if (!copy) {
+         worker.counters.incr(profiling::WorkerCounters::leaf_cache_misses);
+         return std::nullopt;
+      }
+      auto* header = worker.batch_header(0);
+      worker.read_latch(page, header);
+      if (exclusively_latched(header->remote_latch) || header->version != copy->version) {
+         worker.counters.incr(profiling::WorkerCounters::leaf_cache_misses);
+         return std::nullopt;  // the read of the leaf refreshes the copy
+      }
+      parent.checkVersionAndRestart();
+      worker.counters.incr(profiling::WorkerCounters::leaf_cache_hits);
+      return static_cast<Leaf*>(static_cast<void*>(copy))->lookup(key, retValue);
+   }
+   // the copy of a leaf read by a lookup counts towards its admission once it validated
+   void offer_to_cache(GuardO<NodePlaceholder>& leaf, RemotePtr page) {
+      auto& cache = LeafCache::local();
+      if (!cache.enabled()) return;
+      auto* copy = leaf.operator->();
+      auto bytes = Leaf::bytes_for(leaf->as<Leaf>()->count);
+      leaf.release();  // the local copy stays intact until the next latch is taken
+      cache.record(page, copy, bytes);
+   }
+
+   // pointer to the leaf covering key; only inner nodes are read, the leaf is validated by its user
+   RemotePtr locate_leaf(const Key& key) {
+      for ([[maybe_unused]] size_t repeat = 0;; repeat++) {
+         try {
+            GuardO<NodePlaceholder> parent;
+            GuardO<NodePlaceholder> node(read_root(true));
+            if (node->getNodeType() == BTreeNodeType::LEAF) {
+               auto leaf = node.latch.remote_ptr;
+               node.release();
+               return leaf;
+            }
+            for (;;) {
+               auto* inner = node->as<Inner>();
+               auto child = inner->next_child(key);
+               if (inner->level == 1) {
+                  node.release();
+                  return child;
+               }
+               parent = std::move(node);
+               node = read_node(child);
+               parent.checkVersionAndRestart();
+            }
+         } catch (const OLCRestartException&) {
+            ensure(threads::onesided::Worker::my().local_rmemory.get_size() == CONCURRENT_LATCHES);
+         }
+      }
+   }
+   // the storage nodes only know the leaf layout they are built with
+   static constexpr bool storage_writes_supported =
+       std::is_same_v<Key, ::Key> && std::is_same_v<Value, ::Value> && std::is_same_v<Leaf, ActiveLeaf<::Key, ::Value>>;
+
    void insert(Key key, Value value) {
+      // --storage_writes: one RPC to the owner of the leaf instead of latching, reading and writing it back remotely.
+      // Splits and leaves the storage node refuses take the one-sided path below
+      if constexpr (storage_writes_supported) {
+         if (FLAGS_storage_writes && threads::onesided::Worker::my().leaf_insert(locate_leaf(key), key, value)) return;
+      }
+      auto decide = [&](bool, Value& stored) {
+         stored = value;
+         return true;
+      };
+      if constexpr (in_place_supported) {
+         if (FLAGS_in_place_updates && write_in_place(key, decide)) return;
+      }
+      write(key, decide);
+   }
+
+   //=== conditional writes ===//
+   // fn(value) modifies the value of an existing key; returns false if the key does not exist
+   template <typename FN>
+   bool update(Key key, FN&& fn) {
+      auto decide = [&](bool found, Value& stored) {
+         if (found) fn(stored);
+         return found;
+      };
+      if constexpr (in_place_supported) {
+         if (FLAGS_in_place_updates) {
+            if (auto written = write_in_place(key, decide)) return *written;
+         }
+      }
+      return write(key, decide);
+   }
+   // returns false if the key exists
+   bool insert_if_absent(Key key, Value value) {
+      return write(key, [&](bool found, Value& stored) {
+         if (!found) stored = value;
+         return !found;
+      });
+   }
+   // sets the value to desired if it equals expected; returns false if it does not or the key does not exist
+   bool compare_and_swap(Key key, const Value& expected, const Value& desired) {
+      auto decide = [&](bool found, Value& stored) {
+         if (!found || !(stored == expected)) return false;
+         stored = desired;
+         return true;
+      };
+      if constexpr (in_place_supported) {
+         if (FLAGS_in_place_updates) {
+            if (auto written = write_in_place(key, decide)) return *written;
+         }
+      }
+      return write(key, decide);
+   }
+
+   //=== in-place updates ===//
+   // --in_place_updates: a value of an existing key is replaced by a remote CAS on its slot instead of latching the
+   // leaf and writing it back. The updater registers in the latch word of the leaf for the duration of the CAS, which
+   // keeps exclusive latches off the leaf, and bumps the version afterwards so that optimistic readers of the old value
+   // restart. Returns nullopt if the latched path has to take over: the key does not exist or the leaf is latched
+   static constexpr bool in_place_supported = sizeof(Value) == sizeof(uint64_t) && std::is_trivially_copyable_v<Value>;
+
+   template <typename FN>
+   std::optional<bool> write_in_place(const Key& key, FN&& decide) {
+      using InPlace = threads::onesided::Worker::InPlace;
+      auto& worker = threads::onesided::Worker::my();
+      for ([[maybe_unused]] size_t repeat = 0;; repeat++) {
+         try {
+            GuardO<NodePlaceholder> parent;
+            GuardO<NodePlaceholder> node(read_root(true));
+            while (node->getNodeType() == BTreeNodeType::INNER) {
+               parent = std::move(node);
+               if (parent->level == 1)
+                  node = read_leaf(parent->as<Inner>(), parent->as<Inner>()->lower_bound(key));
+               else
+                  node = read_node(parent->as<Inner>()->next_child(key));
+               parent.checkVersionAndRestart();
+            }
+            parent.release();
+            auto* leaf = node->as<Leaf>();
+            auto pos = leaf->lower_bound(key);
+            if (leaf->retired || pos == leaf->end() || !(leaf->key_at(pos) == key)) {
+               node.release();
+               return std::nullopt;
+            }
+            Value value = leaf->value_at(pos);
+            uint64_t expected;
+            std::memcpy(&expected, &value, sizeof(uint64_t));
+            if (!decide(true, value)) {
+               node.release();
+               return false;
+            }
+            uint64_t desired;
+            std::memcpy(&desired, &value, sizeof(uint64_t));
+            auto slot_offset = reinterpret_cast<uint8_t*>(leaf->value_slot(pos)) - reinterpret_cast<uint8_t*>(leaf);
+            ensure(slot_offset % sizeof(uint64_t) == 0);  // RDMA atomics need aligned words
+            auto page = node.latch.remote_ptr;
+            auto version = node.latch.version;
+            node.release();
+            switch (worker.update_in_place(page, version, RemotePtr(page.offset + slot_offset), expected, desired)) {
+               case InPlace::APPLIED:
+                  return true;
+               case InPlace::BUSY:
+                  return std::nullopt;
+               case InPlace::CHANGED:
+                  worker.contention.restarts++;
+                  throw OLCRestartException();
+            }
+         } catch (const OLCRestartException&) {
+            ensure(threads::onesided::Worker::my().local_rmemory.get_size() == CONCURRENT_LATCHES);
+         }
+      }
+   }
+
+   // single traversal for all writes: decide(found, value) sees the current value of key in the optimistically read
+   // leaf and returns whether to write the value it leaves behind. Only then the leaf is latched (the upgrade fails
+   // if it changed since the read) and written back once; a leaf is only split for a key that is not there yet.
+   // decide runs again after a restart and must not have side effects beyond value
+   template <typename FN>
+   bool write(const Key& key, FN&& decide) {
+      SplitHint hint{};  // posted once the latches of this attempt are gone
       for ([[maybe_unused]] size_t repeat = 0;; repeat++) {
          try {
-            GuardO<MetadataPage> g_metadata(metadata);
+            RemotePtr grandparent = NULL_REMOTEPTR;
             GuardO<NodePlaceholder> parent;
-            GuardO<NodePlaceholder> node(g_metadata->getRootPtr());
-            g_metadata.checkVersionAndRestart();
+            GuardO<NodePlaceholder> node(read_root());
             while (node->getNodeType() == BTreeNodeType::INNER) {
                // split logic
                if (!node->as<Inner>()->has_space()) {
                   // split root
                   if (parent.not_used()) {
-                     GuardX<MetadataPage> md_parent(std::move(g_metadata));
+                     GuardX<MetadataPage> md_parent(metadata);
+                     if (md_parent->getRootPtr() != node.latch.remote_ptr) throw OLCRestartException();
                      GuardX<NodePlaceholder> x_node(std::move(node));
-                     auto sepInfo = x_node->as<Inner>()->split();
-                     make_new_root(md_parent, sepInfo.sep, x_node.latch.remote_ptr, sepInfo.rightNode);
+                     ReplicaLatches node_replicas(x_node);
+                     auto sepInfo = x_node->as<Inner>()->split(place(x_node.latch.remote_ptr, NULL_REMOTEPTR));
+                     make_new_root(md_parent, sepInfo.sep, x_node.latch.remote_ptr, sepInfo.rightNode,
+                                   static_cast<uint8_t>(x_node->level + 1));
+                     node_replicas.apply(x_node);
                      throw OLCRestartException(); 
                   }
                   // split inner node
                   GuardX<NodePlaceholder> x_parent(std::move(parent));
+                  ReplicaLatches parent_replicas(x_parent);
                   GuardX<NodePlaceholder> x_node(std::move(node));
-                  auto sepInfo = x_node->as<Inner>()->split();
+                  ReplicaLatches node_replicas(x_node);
+                  auto sepInfo = x_node->as<Inner>()->split(place(x_node.latch.remote_ptr, x_parent.latch.remote_ptr));
                   x_parent->as<Inner>()->insert(sepInfo.sep, x_node.latch.remote_ptr, sepInfo.rightNode);
+                  if (grandparent != NULL_REMOTEPTR && fills_up<Inner>(x_parent->count))
+                     hint = {grandparent.offset, x_parent.latch.remote_ptr.offset, 0};
+                  node_replicas.apply(x_node);
+                  parent_replicas.apply(x_parent);
                   throw OLCRestartException();
                }
+               grandparent = parent.not_used() ? NULL_REMOTEPTR : parent.latch.remote_ptr;
                parent = std::move(node);
                node = GuardO<NodePlaceholder>(parent->as<Inner>()->next_child(key));
                parent.checkVersionAndRestart();
             }
 
-            if (!node->as<Leaf>()->has_space()) {
+            Value value{};
+            bool found = node->as<Leaf>()->lookup(key, value);
+            if (!decide(found, value)) {
+               node.release();
+               parent.release();
+               return false;
+            }
+            if (!found && !node->as<Leaf>()->has_space_for(key)) {
                if (parent.not_used()) {
-                  GuardX<MetadataPage> md_parent(std::move(g_metadata));
+                  GuardX<MetadataPage> md_parent(metadata);
+                  if (md_parent->getRootPtr() != node.latch.remote_ptr) throw OLCRestartException();
                   GuardX<NodePlaceholder> leaf(std::move(node));
-                  auto sepInfo = leaf->as<Leaf>()->split();
-                  make_new_root(md_parent, sepInfo.sep, leaf.latch.remote_ptr, sepInfo.rightNode);
+                  auto sepInfo = leaf->as<Leaf>()->split(place(leaf.latch.remote_ptr, NULL_REMOTEPTR));
+                  make_new_root(md_parent, sepInfo.sep, leaf.latch.remote_ptr, sepInfo.rightNode, 1,
+                                fill_hint(leaf->count), fill_hint(sepInfo.rightCount));
                   throw OLCRestartException();
                }
                GuardX<NodePlaceholder> x_parent(std::move(parent));
+               ReplicaLatches parent_replicas(x_parent);
                GuardX<NodePlaceholder> leaf(std::move(node));
-               auto sepInfo = leaf->as<Leaf>()->split();
-               x_parent->as<Inner>()->insert(sepInfo.sep, leaf.latch.remote_ptr, sepInfo.rightNode);
+               auto sepInfo = leaf->as<Leaf>()->split(place(leaf.latch.remote_ptr, x_parent.latch.remote_ptr));
+               x_parent->as<Inner>()->insert(sepInfo.sep, leaf.latch.remote_ptr, sepInfo.rightNode, fill_hint(leaf->count),
+                                             fill_hint(sepInfo.rightCount));
+               if (grandparent != NULL_REMOTEPTR && fills_up<Inner>(x_parent->count))
+                  hint = {grandparent.offset, x_parent.latch.remote_ptr.offset, 0};
+               parent_replicas.apply(x_parent);
                throw OLCRestartException();
             }
             GuardX<NodePlaceholder> leaf(std::move(node));
+            auto before = leaf->count;
             leaf->as<Leaf>()->upsert(key, value);
-            return;
+            if (!parent.not_used() && leaf->count != before && fills_up<Leaf>(leaf->count)) {
+               hint = {parent.latch.remote_ptr.offset, leaf.latch.remote_ptr.offset, 0};
+               leaf.release();
+               parent.release();
+               post_split_hint(hint);
+            }
+            return true;
          } catch (const OLCRestartException&) {
             ensure(threads::onesided::Worker::my().local_rmemory.get_size() == CONCURRENT_LATCHES);
+            post_split_hint(hint);
          }
       }
    }
 };
+
+// continuation of a paginated scan: the last returned key and whether its leaf was consumed up to the upper fence
+template <typename Key>
+struct ScanToken {
+   bool exhausted{false};  // no keys left in the range
+   Key from{};
+   bool has_last{false};
+   Key last_key{};
+   bool leaf_done{false};
+   typename FenceKeys<Key>::FenceKey leaf_upper{};
+};
+
+// pull-based scan over [from, to] that fetches one leaf at a time on demand and returns at most limit entries.
+// Every leaf is validated before its entries are handed out; a cursor constructed from token() continues
+// after the last returned key
+template <typename Tree>
+struct Cursor {
+   using Key = typename Tree::KeyType;
+   using Value = typename Tree::ValueType;
+   using Leaf = typename Tree::Leaf;
+   Tree& tree;
+   const Key from;
+   const Key to;
+   uint64_t remaining;
+   ScanToken<Key> state;
+   std::array<std::pair<Key, Value>, Leaf::max_entries> buffer{};
+   Pos buffered{0};
+   Pos position{0};
+   bool beyond_to{false};  // the buffered leaf contained a key > to
+
+   Cursor(Tree& tree, Key from, Key to, uint64_t limit) : tree(tree), from(from), to(to), remaining(limit) {
+      state.from = from;
+   }
+   Cursor(Tree& tree, const ScanToken<Key>& token, Key to, uint64_t limit)
+       : tree(tree), from(token.from), to(to), remaining(limit), state(token) {}
+
+   bool next(Key& key, Value& value) {
+      if (remaining == 0) return false;
+      while (position == buffered) {
+         if (state.exhausted || !fetch_leaf()) return false;
+      }
+      key = buffer[position].first;
+      value = buffer[position].second;
+      position++;
+      remaining--;
+      state.has_last = true;
+      state.last_key = key;
+      state.leaf_done = (position == buffered) && !beyond_to;
+      state.exhausted = (position == buffered) && (beyond_to || state.leaf_upper.isInfinity);
+      return true;
+   }
+
+   ScanToken<Key> token() const { return state; }
+
+  private:
+   // returns false if the range is exhausted
+   bool fetch_leaf() {
+      bool exclusive = state.leaf_done;
+      if (exclusive && state.leaf_upper.isInfinity) {
+         state.exhausted = true;
+         return false;
+      }
+      Key seek = exclusive ? state.leaf_upper.key : (state.has_last ? state.last_key : from);
+      Pos staged = 0;
+      bool staged_beyond = false;
+      typename FenceKeys<Key>::FenceKey upper;
+      tree.with_leaf(seek, exclusive, [&](Leaf* leaf) {
+         staged = 0;
+         staged_beyond = false;
+         upper = leaf->fenceKeys.getUpper();
+         for (Pos it = leaf->lower_bound(seek); it != leaf->end(); it++) {
+            auto c_key = leaf->key_at(it);
+            if (c_key > to) {
+               staged_beyond = true;
+               break;
+            }
+            if (c_key < from || (state.has_last && c_key <= state.last_key)) continue;
+            buffer[staged++] = {c_key, leaf->value_at(it)};
+         }
+      });
+      buffered = staged;
+      position = 0;
+      beyond_to = staged_beyond;
+      state.leaf_upper = upper;
+      // an empty leaf moves the cursor to its upper fence
+      state.leaf_done = true;
+      if (buffered == 0 && (beyond_to || upper.isInfinity)) {
+         state.exhausted = true;
+         return false;
+      }
+      return true;
+   }
+};
 }  // namespace onesided
 }  // namespace dtree
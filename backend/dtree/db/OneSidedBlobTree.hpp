@@ -0,0 +1,60 @@
+#pragma once
+#include <array>
+#include <cstdint>
+#include <span>
+
+#include "Defs.hpp"
+#include "OneSidedBTree.hpp"
+//=== One-sided B-Tree with out-of-line values ===//
+// leaves hold a BlobRef per key, the payload lives in the blob heap of a storage node and is fetched with a second,
+// exactly sized READ. Payloads are immutable: an update writes a new blob and swings the reference in the leaf, hence
+// a reference read under a validated leaf version always points to a complete payload. Replaced blobs are not
+// reclaimed.
+
+namespace dtree {
+namespace onesided {
+
+template <typename Key, typename LeafT = ActiveLeaf<Key, BlobRef>>
+struct BlobBTree {
+   using Tree = BTree<Key, BlobRef, LeafT>;
+   Tree tree;
+   BlobBTree(RemotePtr metadata) : tree(metadata) {}
+
+   void insert(const Key& key, const void* data, uint64_t length) {
+      auto& worker = threads::onesided::Worker::my();
+      BlobRef ref{worker.allocate_blob(length), length};
+      worker.write_blob(ref.ptr, data, length);  // payload is complete before the reference becomes visible
+      tree.insert(key, ref);
+   }
+
+   // value points into the worker's blob buffer and stays valid until the next blob read of this worker
+   bool lookup(const Key& key, std::span<uint8_t>& value) {
+      BlobRef ref;
+      if (!tree.lookup(key, ref)) return false;
+      auto& worker = threads::onesided::Worker::my();
+      worker.read_blobs(&ref, 1);
+      value = std::span<uint8_t>(worker.blob_slot(0), ref.length);
+      return true;
+   }
+
+   // traverses for all references first and fetches the payloads with one batch of parallel READs;
+   // missing keys yield empty spans, returns the number of keys found
+   size_t multi_lookup(std::span<const Key> keys, std::span<std::span<uint8_t>> values) {
+      ensure(keys.size() <= MAX_BLOB_BATCH);
+      ensure(values.size() >= keys.size());
+      std::array<BlobRef, MAX_BLOB_BATCH> refs;
+      std::array<size_t, MAX_BLOB_BATCH> positions;
+      size_t found = 0;
+      for (size_t k_i = 0; k_i < keys.size(); k_i++) {
+         values[k_i] = std::span<uint8_t>();
+         if (tree.lookup(keys[k_i], refs[found])) positions[found++] = k_i;
+      }
+      auto& worker = threads::onesided::Worker::my();
+      worker.read_blobs(refs.data(), found);
+      for (size_t f_i = 0; f_i < found; f_i++)
+         values[positions[f_i]] = std::span<uint8_t>(worker.blob_slot(f_i), refs[f_i].length);
+      return found;
+   }
+};
+}  // namespace onesided
+}  // namespace dtree
@@ -0,0 +1,56 @@
+#pragma once
+#include <algorithm>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+#include "Defs.hpp"
+#include "OneSidedBTree.hpp"
+//=== Range-partitioned forest of one-sided B-Trees ===//
+// every storage node owns an independent sub-tree for one key range: its root hangs off the metadata page of that
+// node and all nodes of the sub-tree are allocated there, hence splits never cross storage nodes and a range scan
+// only touches the partitions it overlaps. The routing table is static and identical on all compute nodes.
+
+namespace dtree {
+namespace onesided {
+
+template <typename Key, typename Value, typename LeafT = ActiveLeaf<Key, Value>>
+struct Forest {
+   using Tree = BTree<Key, Value, LeafT>;
+   using KeyType = Key;
+   using ValueType = Value;
+   std::vector<Key> lower_bounds;  // partition p covers [lower_bounds[p], lower_bounds[p + 1])
+   std::vector<Tree> trees;
+
+   // metadata[p] is the metadata page of the storage node owning partition p
+   Forest(std::span<const RemotePtr> metadata, std::span<const Key> lower_bounds)
+       : lower_bounds(lower_bounds.begin(), lower_bounds.end()) {
+      ensure(metadata.size() == lower_bounds.size() && !lower_bounds.empty());
+      ensure(std::is_sorted(lower_bounds.begin(), lower_bounds.end()));
+      trees.reserve(metadata.size());
+      for (auto md : metadata) trees.emplace_back(md, md.getOwner());
+   }
+
+   // keys below the first bound belong to the first partition
+   size_t route(const Key& key) {
+      auto it = std::upper_bound(lower_bounds.begin(), lower_bounds.end(), key);
+      return (it == lower_bounds.begin()) ? 0 : static_cast<size_t>(std::distance(lower_bounds.begin(), it) - 1);
+   }
+
+   bool lookup(Key key, Value& retValue) { return trees[route(key)].lookup(key, retValue); }
+   void insert(Key key, Value value) { trees[route(key)].insert(key, value); }
+
+   // partitions are scanned one after the other in key order, each with its part of [from, to]
+   template <typename FN>
+   void range_scan(const Key from, const Key to, FN scan_function) {
+      if (to < from) return;
+      auto last = route(to);
+      for (auto p_i = route(from); p_i <= last; p_i++) {
+         auto begin = (p_i == 0) ? from : std::max(from, lower_bounds[p_i]);
+         auto end = (p_i == last) ? to : std::min(to, lower_bounds[p_i + 1] - 1);
+         if (begin <= end) trees[p_i].range_scan(begin, end, scan_function);
+      }
+   }
+};
+}  // namespace onesided
+}  // namespace dtree
@@ -0,0 +1,116 @@
+#pragma once
+#include <cstdint>
+#include <type_traits>
+
+#include "Defs.hpp"
+#include "OneSidedBTree.hpp"
+//=== Hybrid tree: inner levels via RPC, leaves one-sided ===//
+// the storage nodes traverse the inner levels of the one-sided tree on their local memory and return the leaf, one
+// round trip per storage node the path crosses instead of one read per level. Leaves are read and updated one-sided,
+// scans follow the right links. The storage node does not latch the path, therefore every leaf is checked to still
+// cover the key when it is read; structure modifications are left to the one-sided tree. The traversal is not
+// forwarded between storage nodes, a path that alternates between them costs one RPC per crossing; design_experiments
+// therefore places new nodes next to their parent.
+
+namespace dtree {
+namespace onesided {
+
+template <typename Key, typename Value, typename LeafT = ActiveLeaf<Key, Value>>
+struct HybridTree {
+   using Tree = BTree<Key, Value, LeafT>;
+   using KeyType = Key;
+   using ValueType = Value;
+   using Leaf = LeafT;
+   static_assert(std::is_same_v<Key, ::Key>, "storage nodes only traverse trees with the global key type");
+   Tree tree;
+   HybridTree(RemotePtr metadata, AllocationPolicy policy = parse_allocation_policy(FLAGS_allocation_policy))
+       : tree(metadata, EMPTY_NODEID, policy) {}
+
+   // one RPC per storage node on the path; an aborted descent starts over at the metadata page
+   RemotePtr locate_leaf(const Key& key) {
+      auto& worker = threads::onesided::Worker::my();
+      auto start = tree.metadata;
+      bool from_metadata = true;
+      for (;;) {
+         auto response = worker.traverse(start, from_metadata, key);
+         if (response.rc == rdma::RESULT::ABORTED) {
+            start = tree.metadata;
+            from_metadata = true;
+            continue;
+         }
+         if (response.leaf) return RemotePtr(response.node);
+         start = RemotePtr(response.node);
+         from_metadata = false;
+      }
+   }
+   // the leaf may have been split or relocated since the storage node passed its parent
+   static bool covers(Leaf* leaf, const Key& key) {
+      auto lower = leaf->fenceKeys.getLower();
+      auto upper = leaf->fenceKeys.getUpper();
+      return (lower.isInfinity || key > lower.key) && (upper.isInfinity || key <= upper.key);
+   }
+   GuardO<NodePlaceholder> read_leaf(const Key& key) {
+      GuardO<NodePlaceholder> leaf(locate_leaf(key));
+      if (leaf->getNodeType() != BTreeNodeType::LEAF || leaf->retired || !covers(leaf->as<Leaf>(), key))
+         throw OLCRestartException();
+      return leaf;
+   }
+
+   bool lookup(Key key, Value& retValue) {
+      for ([[maybe_unused]] size_t repeat = 0;; repeat++) {
+         try {
+            GuardO<NodePlaceholder> leaf(read_leaf(key));
+            return leaf->as<Leaf>()->lookup(key, retValue);
+         } catch (const OLCRestartException&) {
+            ensure(threads::onesided::Worker::my().local_rmemory.get_size() == CONCURRENT_LATCHES);
+         }
+      }
+   }
+
+   // a full leaf is split by the one-sided tree
+   void insert(Key key, Value value) {
+      for ([[maybe_unused]] size_t repeat = 0;; repeat++) {
+         try {
+            GuardO<NodePlaceholder> leaf(read_leaf(key));
+            if (!leaf->as<Leaf>()->has_space_for(key)) {
+               leaf.release();
+               break;
+            }
+            GuardX<NodePlaceholder> x_leaf(std::move(leaf));
+            x_leaf->as<Leaf>()->upsert(key, value);
+            return;
+         } catch (const OLCRestartException&) {
+            ensure(threads::onesided::Worker::my().local_rmemory.get_size() == CONCURRENT_LATCHES);
+         }
+      }
+      tree.insert(key, value);
+   }
+
+   // same guarantees as BTree::range_scan. A right neighbour is only accepted if it starts where the previous leaf
+   // ended, otherwise the scan resumes with a new descent
+   template <typename FN>
+   void range_scan(const Key from, const Key to, FN scan_function) {
+      typename Tree::template ScanState<FN> state{scan_function, from, to};
+      for ([[maybe_unused]] size_t repeat = 0;; repeat++) {
+         try {
+            GuardO<NodePlaceholder> leaf(read_leaf(state.resume_key()));
+            for (;;) {
+               auto finished = state.stage(leaf->as<Leaf>());
+               auto upper = leaf->as<Leaf>()->fenceKeys.getUpper();
+               finished |= upper.isInfinity;
+               auto right = leaf->getRightLink();
+               leaf.release();
+               state.deliver();
+               if (finished) return;
+               leaf = GuardO<NodePlaceholder>(right);
+               auto lower = leaf->as<Leaf>()->fenceKeys.getLower();
+               if (leaf->retired || lower.isInfinity || lower.key != upper.key) throw OLCRestartException();
+            }
+         } catch (const OLCRestartException&) {
+            ensure(threads::onesided::Worker::my().local_rmemory.get_size() == CONCURRENT_LATCHES);
+         }
+      }
+   }
+};
+}  // namespace onesided
+}  // namespace dtree
@@ -74,7 +74,7 @@ struct AsyncOptimisticLatch : public AbstractLatch<T> {
       ensure(super::remote_ptr != NULL_REMOTEPTR);
       my_thread::my().read_latch(super::remote_ptr, super::rdma_mem.latch_buffer);
       auto* ph = static_cast<PageHeader*>(super::rdma_mem.latch_buffer);
-      if (ph->remote_latch == EXCLUSIVE_LOCKED) return false;
+      if (exclusively_latched(ph->remote_latch)) return false;
       super::version = ph->version;
       return true;
    };
@@ -88,7 +88,7 @@ struct AsyncOptimisticLatch : public AbstractLatch<T> {
    bool validate() {
       my_thread::my().read_latch(super::remote_ptr, super::rdma_mem.latch_buffer);
       auto* ph = static_cast<PageHeader*>(static_cast<void*>(super::rdma_mem.latch_buffer));
-      if (ph->remote_latch == EXCLUSIVE_LOCKED || ph->version != super::version) return false;
+      if (exclusively_latched(ph->remote_latch) || ph->version != super::version) return false;
       return true;
    }
 };
@@ -112,7 +112,10 @@ struct OptimisticLatch : public AbstractLatch<T> {
       ensure(super::remote_ptr != NULL_REMOTEPTR);
       my_thread::my().read_latch(super::remote_ptr, super::rdma_mem.latch_buffer);
       auto* ph = static_cast<PageHeader*>(super::rdma_mem.latch_buffer);
-      if (ph->remote_latch == EXCLUSIVE_LOCKED) return false;
+      if (exclusively_latched(ph->remote_latch)) {
+         my_thread::my().contention.latch_failures++;
+         return false;
+      }
       super::version = ph->version;
       // Since CL are read consistent we can use the below shortcut
       if constexpr (sizeof(T) <= 32) {
@@ -124,10 +127,28 @@ struct OptimisticLatch : public AbstractLatch<T> {
       return true;
    };
 
+   // reads only the first bytes of the object (must include the header); the rest is fetched with read_range
+   bool try_latch_prefix(size_t bytes) {
+      ensure(super::remote_ptr != NULL_REMOTEPTR);
+      ensure(bytes >= sizeof(PageHeader) && bytes <= sizeof(T));
+      my_thread::my().remote_read_range(super::remote_ptr, super::rdma_mem.local_copy, 0, bytes);
+      if (exclusively_latched(super::rdma_mem.local_copy->remote_latch)) {
+         my_thread::my().contention.latch_failures++;
+         return false;
+      }
+      super::version = super::rdma_mem.local_copy->version;
+      return true;
+   }
+
+   void read_range(size_t offset, size_t bytes) {
+      ensure(offset + bytes <= sizeof(T));
+      my_thread::my().remote_read_range(super::remote_ptr, super::rdma_mem.local_copy, offset, bytes);
+   }
+
    bool validate() {
       my_thread::my().read_latch(super::remote_ptr, super::rdma_mem.latch_buffer);
       auto* ph = static_cast<PageHeader*>(static_cast<void*>(super::rdma_mem.latch_buffer));
-      if (ph->remote_latch == EXCLUSIVE_LOCKED || ph->version != super::version) return false;
+      if (exclusively_latched(ph->remote_latch) || ph->version != super::version) return false;
       return true;
    }
 };
@@ -157,6 +178,7 @@ struct ExclusiveLatch : public AbstractLatch<T> {
                                                              &this->rdma_mem.latch_buffer->remote_latch);
       this->version = this->rdma_mem.local_copy->version;
       if (latched_) this->latched = true;
+      else my_thread::my().contention.latch_failures++;
       return latched_;
    }
    // we have a copy already in optimistic state and want to upgrade the latch
@@ -167,11 +189,14 @@ struct ExclusiveLatch : public AbstractLatch<T> {
       auto latched_ =
           my_thread::my().compareSwap(UNLOCKED, EXCLUSIVE_LOCKED, this->remote_ptr, dtree::rdma::completion::signaled,
                                       &this->rdma_mem.latch_buffer->remote_latch);
-      if (!latched_) { return false; }
+      if (!latched_) {
+         my_thread::my().contention.latch_failures++;
+         return false;
+      }
       this->latched = true;  // important for unlatch
       my_thread::my().read_latch(this->remote_ptr, this->rdma_mem.latch_buffer);
       auto* ph = static_cast<PageHeader*>(static_cast<void*>(this->rdma_mem.latch_buffer));
-      ensure(ph->remote_latch == EXCLUSIVE_LOCKED);
+      ensure(exclusively_latched(ph->remote_latch));
       if (ph->version != version) {
          version_mismatch = true;
          return false;
@@ -193,28 +218,89 @@ struct ExclusiveLatch : public AbstractLatch<T> {
       if (!version_mismatch) {
          (this->version)++;
          this->rdma_mem.local_copy->version = this->version;
-         ensure(static_cast<T*>(this->rdma_mem.local_copy)->remote_latch == EXCLUSIVE_LOCKED);
+         ensure(exclusively_latched(static_cast<T*>(this->rdma_mem.local_copy)->remote_latch));
+         // the latch word is left out, updaters may be registering and backing off concurrently
          // TODO unsignaled
-         my_thread::my().remote_write<T>(this->remote_ptr, static_cast<T*>(this->rdma_mem.local_copy),
-                                         dtree::rdma::completion::signaled);
+         my_thread::my().remote_write_range(this->remote_ptr, this->rdma_mem.local_copy, sizeof(uint64_t),
+                                            sizeof(T) - sizeof(uint64_t));
       }
-      ensure(my_thread::my().compareSwap(EXCLUSIVE_LOCKED, UNLOCKED, this->remote_ptr,
-                                         dtree::rdma::completion::signaled,
-                                         &this->rdma_mem.latch_buffer->remote_latch));
+      auto latch = my_thread::my().fetchAdd(EXCLUSIVE_UNLOCK_TO_BE_ADDED, this->remote_ptr,
+                                            dtree::rdma::completion::signaled,
+                                            &this->rdma_mem.latch_buffer->remote_latch);
+      ensure(exclusively_latched(latch));
       this->latched = false;
    };
 };
 
+// readers register in the latch word with an FAA and back off while it is exclusively latched; exclusive latches are
+// only granted once no reader is registered, hence no split or write-back changes the copy read under the latch.
+// In-place updaters share the registration count and are not kept out: with --in_place_updates a value slot may be
+// swapped while the copy is read, which then holds either value of that slot. There is no writer intent, a steady
+// stream of readers keeps the exclusive CAS failing and starves writers of a hot leaf
+template <ConceptObject T>
+struct SharedLatch : public AbstractLatch<T> {
+   using super = AbstractLatch<T>;
+   using my_thread = dtree::threads::onesided::Worker;
+   explicit SharedLatch(RemotePtr remote_ptr) : AbstractLatch<T>(remote_ptr) {}
+   explicit SharedLatch(SharedLatch&& o_other) : AbstractLatch<T>(std::move(o_other)) {}
+
+   SharedLatch& operator=(SharedLatch&& other) {
+      *static_cast<AbstractLatch<T>*>(this) = std::move(*static_cast<AbstractLatch<T>*>(&other));
+      return *this;
+   }
+
+   SharedLatch& operator=(SharedLatch& other) = delete;
+   SharedLatch(SharedLatch& other) = delete;  // copy constructor
+   // reads the first bytes of the object (must include the header); the rest is fetched with read_range
+   bool try_latch(size_t bytes = sizeof(T)) {
+      ensure(super::remote_ptr != NULL_REMOTEPTR);
+      ensure(bytes >= sizeof(PageHeader) && bytes <= sizeof(T));
+      auto latch = my_thread::my().fetchAdd(1, super::remote_ptr, dtree::rdma::completion::signaled,
+                                            &super::rdma_mem.latch_buffer->remote_latch);
+      if (exclusively_latched(latch)) {
+         deregister();
+         my_thread::my().contention.latch_failures++;
+         return false;
+      }
+      super::latched = true;
+      my_thread::my().remote_read_range(super::remote_ptr, super::rdma_mem.local_copy, 0, bytes);
+      super::version = super::rdma_mem.local_copy->version;
+      return true;
+   }
+
+   void read_range(size_t offset, size_t bytes) {
+      ensure(super::latched && offset + bytes <= sizeof(T));
+      my_thread::my().remote_read_range(super::remote_ptr, super::rdma_mem.local_copy, offset, bytes);
+   }
+
+   void unlatch() {
+      ensure(super::latched);
+      deregister();
+      super::latched = false;
+   }
+
+  private:
+   void deregister() {
+      my_thread::my().fetchAdd(~uint64_t(0), super::remote_ptr, dtree::rdma::completion::signaled,
+                               &super::rdma_mem.latch_buffer->remote_latch);
+   }
+};
+
 template <ConceptObject T>
 struct AllocationLatch : public AbstractLatch<T> {
    // returns true successfully
    using super = AbstractLatch<T>;
    using my_thread = dtree::threads::onesided::Worker;
-   AllocationLatch() {
-      // read remote data
-      if (my_thread::my().remote_pages.empty()) { my_thread::my().refresh_caches(); }
-      if (!my_thread::my().remote_pages.try_pop(super::remote_ptr))
-         throw std::logic_error("could not get a new remote page");
+   AllocationLatch() : AllocationLatch(EMPTY_NODEID) {}
+   // placement: storage node of the new page, EMPTY_NODEID takes a random page of the thread-local cache
+   explicit AllocationLatch(NodeID placement) {
+      if (placement != EMPTY_NODEID) {
+         super::remote_ptr = my_thread::my().allocate_page(placement);
+      } else {
+         if (my_thread::my().remote_pages.empty()) { my_thread::my().refresh_caches(); }
+         if (!my_thread::my().remote_pages.try_pop(super::remote_ptr))
+            throw std::logic_error("could not get a new remote page");
+      }
       auto success = threads::onesided::Worker::my().local_rmemory.try_pop(
           super::rdma_mem);  // cannot use constructor of AL latch here
       onesided::allocateInRDMARegion(static_cast<T*>(static_cast<void*>(super::rdma_mem.local_copy)));
@@ -256,6 +342,12 @@ struct GuardO {
          ;
    }
 
+   // partial read: only the first prefix_bytes are valid in the local copy; use fetch() for the rest
+   GuardO(RemotePtr rptr, size_t prefix_bytes) : latch(rptr), moved(false) {
+      while (!latch.try_latch_prefix(prefix_bytes))
+         ;
+   }
+
    // TODO check again
    template <class T2>
    GuardO(RemotePtr current, GuardO<T2>& parent) {
@@ -291,9 +383,15 @@ struct GuardO {
    // copy constructor
    GuardO(const GuardO&) = delete;
    bool not_used() { return moved; }
+   // fetches further bytes of a partially read object; consistency is checked by the final validation
+   void fetch(size_t offset, size_t bytes) {
+      ensure(!moved);
+      latch.read_range(offset, bytes);
+   }
    void checkVersionAndRestart() {
       if (!moved) {
          if (latch.validate()) return;
+         threads::onesided::Worker::my().contention.restarts++;
          if (std::uncaught_exceptions() == 0) throw OLCRestartException();
       }
    }
@@ -322,6 +420,78 @@ struct GuardO {
    }
 };
 
+// shared counterpart of GuardO with the same read interface: exclusive writers are kept off the node while the
+// guard is held, therefore reads through it never restart; only in-place updates of single values can still land.
+// Held guards keep writers waiting, release them early
+template <typename T>
+struct GuardS {
+   SharedLatch<T> latch;
+   bool moved = false;
+
+   GuardS() : latch(NULL_REMOTEPTR), moved(true) {}
+
+   explicit GuardS(RemotePtr rptr) : latch(rptr), moved(false) {
+      int mask = 1;
+      while (!latch.try_latch()) { BACKOFF(); }
+   }
+
+   // partial read: only the first prefix_bytes are valid in the local copy; use fetch() for the rest
+   GuardS(RemotePtr rptr, size_t prefix_bytes) : latch(rptr), moved(false) {
+      int mask = 1;
+      while (!latch.try_latch(prefix_bytes)) { BACKOFF(); }
+   }
+
+   GuardS(GuardS&& other) : latch(std::move(other.latch)) {
+      ensure(!other.moved);
+      other.moved = true;
+      moved = false;
+   }
+
+   // move assignment operator
+   GuardS& operator=(GuardS&& other) {
+      if (!moved) {
+         latch.unlatch();
+         [[maybe_unused]] auto s = threads::onesided::Worker::my().local_rmemory.try_push(latch.rdma_mem);
+      }
+      latch.moved = false;
+      moved = false;
+      latch = std::move(other.latch);  // calls move assignment
+      other.moved = true;
+      return *this;
+   }
+
+   // assignment operator
+   GuardS& operator=(const GuardS&) = delete;
+
+   // copy constructor
+   GuardS(const GuardS&) = delete;
+   bool not_used() { return moved; }
+   void fetch(size_t offset, size_t bytes) {
+      ensure(!moved);
+      latch.read_range(offset, bytes);
+   }
+   // nothing to validate, callers written against GuardO keep working
+   void checkVersionAndRestart() {}
+
+   // destructor
+   ~GuardS() {
+      if (!moved && latch.latched) latch.unlatch();
+   }
+
+   T* operator->() {
+      ensure(!moved);
+      return static_cast<T*>(latch.rdma_mem.local_copy);
+   }
+   void release() {
+      if (!moved) {
+         latch.unlatch();
+         moved = true;
+         latch.moved = true;
+         [[maybe_unused]] auto s = threads::onesided::Worker::my().local_rmemory.try_push(latch.rdma_mem);
+      }
+   }
+};
+
 template <class T>
 struct GuardX {
    ExclusiveLatch<T> latch;
@@ -388,5 +558,19 @@ struct GuardX {
    }
 };
 
+//=== Latch policies ===//
+// how a tree reads its leaves: optimistically, a read that races with a writer restarts, or under a shared latch,
+// which costs two remote atomics per leaf but lets long scans and readers of hot leaves progress under writers
+struct OptimisticReads {
+   template <typename T>
+   using ReadGuard = GuardO<T>;
+   static constexpr bool optimistic{true};
+};
+struct SharedReads {
+   template <typename T>
+   using ReadGuard = GuardS<T>;
+   static constexpr bool optimistic{false};
+};
+
 }  // namespace onesided
 }  // namespace dtree
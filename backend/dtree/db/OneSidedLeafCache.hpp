@@ -0,0 +1,111 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <cstring>
+#include <unordered_map>
+#include <vector>
+
+#include "Defs.hpp"
+#include "OneSidedTypes.hpp"
+#include "dtree/Config.hpp"
+//=== Compute-side cache of hot leaves ===//
+// skewed lookups read the same few leaves over and over. Every worker keeps copies of the leaves it reads most often
+// and uses a copy once a read of the page header shows the leaf neither latched nor with a newer version, hence only
+// the header instead of the whole leaf crosses the network. A leaf is admitted once a count-min sketch of the reads
+// estimates LEAF_CACHE_ADMIT of them; the counters are halved every LEAF_CACHE_AGING reads such that leaves that
+// cooled down lose their claim. Frames are replaced with CLOCK.
+
+namespace dtree {
+namespace onesided {
+
+struct LeafCache {
+   static constexpr size_t SKETCH_ROWS{4};
+   static_assert((LEAF_CACHE_SKETCH_WIDTH & (LEAF_CACHE_SKETCH_WIDTH - 1)) == 0, "sketch width must be a power of 2");
+
+   struct Frame {
+      uint64_t page{0};  // offset of the cached leaf, 0 marks a free frame
+      bool referenced{false};
+   };
+   std::vector<Frame> frames;
+   std::vector<uint8_t> copies;                   // BTREE_NODE_SIZE bytes per frame
+   std::unordered_map<uint64_t, uint64_t> index;  // page -> frame
+   std::array<std::array<uint8_t, LEAF_CACHE_SKETCH_WIDTH>, SKETCH_ROWS> sketch{};
+   uint64_t hand{0};
+   uint64_t reads{0};  // since the last aging
+
+   explicit LeafCache(uint64_t capacity) : frames(capacity), copies(capacity * BTREE_NODE_SIZE) {
+      index.reserve(capacity);
+   }
+   // cache of the calling worker, --leaf_cache_mb is split over the workers of the compute node
+   static LeafCache& local() {
+      thread_local LeafCache cache((FLAGS_leaf_cache_mb << 20) / BTREE_NODE_SIZE / std::max<uint64_t>(1, FLAGS_worker));
+      return cache;
+   }
+   bool enabled() const { return !frames.empty(); }
+
+   // copy of page or nullptr; the copy still has to be validated against the header of the page
+   PageHeader* find(RemotePtr page) {
+      auto it = index.find(page.offset);
+      if (it == index.end()) return nullptr;
+      frames[it->second].referenced = true;
+      return copy_of(it->second);
+   }
+
+   // counts a read of page; leaf holds its validated copy of which the first bytes are used. A cached copy is
+   // refreshed, others are admitted once the page is read frequently
+   void record(RemotePtr page, const void* leaf, uint64_t bytes) {
+      ensure(bytes <= BTREE_NODE_SIZE);
+      auto it = index.find(page.offset);
+      if (it != index.end()) {
+         std::memcpy(copy_of(it->second), leaf, bytes);
+         return;
+      }
+      if (count(page.offset) < LEAF_CACHE_ADMIT) return;
+      auto f_i = victim();
+      if (frames[f_i].page != 0) index.erase(frames[f_i].page);
+      frames[f_i] = {page.offset, true};
+      std::memcpy(copy_of(f_i), leaf, bytes);
+      index[page.offset] = f_i;
+   }
+
+  private:
+   PageHeader* copy_of(uint64_t f_i) {
+      return static_cast<PageHeader*>(static_cast<void*>(copies.data() + (f_i * BTREE_NODE_SIZE)));
+   }
+   static size_t slot(uint64_t page, size_t row) {
+      static constexpr std::array<uint64_t, SKETCH_ROWS> seeds{0x9E3779B97F4A7C15, 0xC2B2AE3D27D4EB4F,
+                                                               0x165667B19E3779F9, 0xD6E8FEB86659FD93};
+      return static_cast<size_t>(((page / BTREE_NODE_SIZE) * seeds[row]) >> 32) & (LEAF_CACHE_SKETCH_WIDTH - 1);
+   }
+   // increments the counters of page and returns its estimated reads
+   uint8_t count(uint64_t page) {
+      if (++reads == LEAF_CACHE_AGING) {
+         for (auto& row : sketch)
+            for (auto& counter : row) counter = static_cast<uint8_t>(counter / 2);
+         reads = 0;
+      }
+      uint8_t estimate = UINT8_MAX;
+      for (size_t r_i = 0; r_i < SKETCH_ROWS; r_i++) {
+         auto& counter = sketch[r_i][slot(page, r_i)];
+         if (counter < UINT8_MAX) counter++;
+         estimate = std::min(estimate, counter);
+      }
+      return estimate;
+   }
+   // CLOCK: referenced frames get a second chance
+   uint64_t victim() {
+      for (;; hand = (hand + 1) % frames.size()) {
+         auto& frame = frames[hand];
+         if (frame.page != 0 && frame.referenced) {
+            frame.referenced = false;
+            continue;
+         }
+         auto f_i = hand;
+         hand = (hand + 1) % frames.size();
+         return f_i;
+      }
+   }
+};
+}  // namespace onesided
+}  // namespace dtree
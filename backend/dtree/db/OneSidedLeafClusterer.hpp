@@ -0,0 +1,89 @@
+#pragma once
+#include <atomic>
+#include <cstdint>
+#include <cstring>
+
+#include "Defs.hpp"
+#include "OneSidedBTree.hpp"
+#include "OneSidedStorageOps.hpp"
+#include "OneSidedTypes.hpp"
+//=== Storage-side leaf clusterer of the one-sided tree ===//
+// runs in the maintenance thread of a storage node next to the split daemon and relocates the leaves below a local
+// level 1 inner node into a run of consecutive local pages in key order, such that ascending scans fetch them with few
+// large READs. Parent and all its leaves are latched with CPU atomics like in the split daemon; the old pages are
+// marked retired and unlatched with a newer version, hence compute nodes that still reach them through a stale parent
+// fail their validation or see the retired flag and restart. Retired pages are not reclaimed. Busy, replicated and
+// partly remote parents are skipped. Right links are only redirected within the run, do not use on a
+// BLinkTree.
+
+namespace dtree {
+namespace onesided {
+
+template <typename Key, typename Value, typename LeafT = ActiveLeaf<Key, Value>>
+struct LeafClusterer {
+   using Tree = BTree<Key, Value, LeafT>;
+   using Leaf = LeafT;
+   using Inner = BTreeInner<Key>;
+   NodeID node_id;
+   uint64_t& page_counter;  // pages handed out of node_buffer, shared with the FAAs of the compute nodes
+   uint8_t* node_buffer;
+   uint64_t cursor{0};  // next page of node_buffer to inspect
+   uint64_t runs{0};
+
+   LeafClusterer(NodeID node_id, uint64_t& page_counter, uint8_t* node_buffer)
+       : node_id(node_id), page_counter(page_counter), node_buffer(node_buffer) {}
+
+   RemotePtr page(uint64_t p_idx) {
+      return RemotePtr(node_id, (p_idx * BTREE_NODE_SIZE) + reinterpret_cast<uintptr_t>(node_buffer));
+   }
+
+   // inspects the next CLUSTER_SCAN_PAGES pages, wraps around at the last handed out page
+   void step() {
+      auto handed_out = std::atomic_ref<uint64_t>(page_counter).load(std::memory_order_acquire);
+      for (uint64_t p_i = 0; p_i < CLUSTER_SCAN_PAGES; p_i++) {
+         if (cursor >= handed_out) cursor = 0;
+         if (handed_out == 0) return;
+         if (cluster(page(cursor++))) runs++;
+      }
+   }
+
+   // returns true if the leaves below parent_ptr were relocated
+   bool cluster(RemotePtr parent_ptr) {
+      auto* parent = local_page<Inner>(parent_ptr);
+      if (!LocalLatch::try_latch(parent)) return false;  // free pages stay latched, as do busy nodes
+      auto children = static_cast<Pos>(parent->end() + 1);
+      bool relocate = parent->getNodeType() == BTreeNodeType::INNER && parent->level == 1 && !parent->replicated() &&
+                      Tree::contiguous_run(parent, 0, children) < children;
+      for (Pos c_i = 0; relocate && c_i < children; c_i++) relocate = parent->children[c_i].getOwner() == node_id;
+      Pos latched = 0;
+      while (relocate && latched < children) {
+         if (!LocalLatch::latch(local_page<PageHeader>(parent->children[latched]))) break;
+         latched++;
+      }
+      if (!relocate || latched < children) {
+         for (Pos c_i = 0; c_i < latched; c_i++)
+            LocalLatch::unlatch(local_page<PageHeader>(parent->children[c_i]), false);
+         LocalLatch::unlatch(parent, false);
+         return false;
+      }
+      auto first = std::atomic_ref<uint64_t>(page_counter).fetch_add(static_cast<uint64_t>(children));
+      for (Pos c_i = 0; c_i < children; c_i++) {
+         auto* leaf = local_page<Leaf>(parent->children[c_i]);
+         auto target_ptr = page(first + c_i);
+         auto* target = local_page<Leaf>(target_ptr);
+         std::memcpy(static_cast<void*>(target), static_cast<void*>(leaf), sizeof(Leaf));
+         target->version = leaf->version + 1;
+         if (c_i + 1 < children) target->setRightLink(page(first + c_i + 1));
+         std::atomic_ref<uint64_t>(target->remote_latch).store(UNLOCKED, std::memory_order_release);
+         parent->children[c_i] = target_ptr;
+         parent->fill_hints[c_i] = Tree::fill_hint(leaf->count);
+         // readers that still hold the old pointer must get past the latch to notice the relocation
+         leaf->retired = 1;
+         LocalLatch::unlatch(leaf, true);
+      }
+      LocalLatch::unlatch(parent, true);
+      return true;
+   }
+};
+}  // namespace onesided
+}  // namespace dtree
@@ -0,0 +1,151 @@
+#pragma once
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <limits>
+#include <span>
+#include <type_traits>
+
+#include "Defs.hpp"
+#include "OneSidedBTree.hpp"
+#include "OneSidedHybridTree.hpp"
+//=== Adaptive routing between one-sided and storage-side execution ===//
+// every operation on the one-sided tree either runs one-sided or is shipped to the storage nodes, which execute it
+// on the same tree with local latches (see OneSidedStorageOps.hpp). Per key range the router of a worker tracks the
+// contention its one-sided operations meet (nodes found latched, lost CAS, failed validations) and the size of the
+// scans. Ranges with hot writers move to the storage nodes, where a latch is held for nanoseconds instead of round
+// trips, and so do ranges with large scans, which then need one request per storage node instead of two reads per
+// leaf. Decisions are taken per range every ROUTER_EPOCH operations; storage-routed ranges keep running every
+// ROUTER_PROBE-th point operation one-sided to notice when the contention is gone.
+
+namespace dtree {
+namespace onesided {
+
+enum class Route : uint8_t { ONE_SIDED, STORAGE };
+
+template <typename Key, typename Value, typename LeafT = ActiveLeaf<Key, Value>>
+struct AdaptiveRouter {
+   using Tree = BTree<Key, Value, LeafT>;
+   using KeyType = Key;
+   using ValueType = Value;
+   using Leaf = LeafT;
+   static_assert(Tree::storage_writes_supported, "storage nodes only execute operations on the global tree types");
+   static constexpr uint64_t ALL_ROWS = std::numeric_limits<uint64_t>::max();  // storage_scan without a limit
+
+   struct RangeStats {
+      Route points{Route::ONE_SIDED};
+      Route scans{Route::ONE_SIDED};
+      uint64_t operations{0};  // since the last decision
+      uint64_t measured{0};    // point operations run one-sided
+      uint64_t contention{0};  // met by the measured operations
+      uint64_t scans_seen{0};
+      uint64_t rows{0};
+   };
+   HybridTree<Key, Value, LeafT> hybrid;  // its tree executes the one-sided operations
+   const uint64_t range_width;
+   std::array<RangeStats, ROUTER_RANGES> ranges{};
+   uint64_t switches{0};
+
+   // keys are expected in [0, key_domain), larger keys share the last range
+   AdaptiveRouter(RemotePtr metadata, uint64_t key_domain)
+       : hybrid(metadata), range_width(std::max<uint64_t>(1, key_domain / ROUTER_RANGES)) {}
+
+   RangeStats& range_of(const Key& key) { return ranges[std::min<uint64_t>(key / range_width, ROUTER_RANGES - 1)]; }
+
+   void decide(RangeStats& range) {
+      if (++range.operations < ROUTER_EPOCH) return;
+      auto before = std::make_pair(range.points, range.scans);
+      if (range.measured > 0) {
+         auto rate = static_cast<double>(range.contention) / static_cast<double>(range.measured);
+         if (range.points == Route::ONE_SIDED && rate > ROUTER_CONTENTION_HIGH) range.points = Route::STORAGE;
+         if (range.points == Route::STORAGE && rate < ROUTER_CONTENTION_LOW) range.points = Route::ONE_SIDED;
+      }
+      if (range.scans_seen > 0)
+         range.scans = (range.rows / range.scans_seen > ROUTER_SCAN_ROWS) ? Route::STORAGE : Route::ONE_SIDED;
+      if (before != std::make_pair(range.points, range.scans)) switches++;
+      range = {range.points, range.scans};
+   }
+   // runs a point operation one-sided if the range is routed there or the operation is a probe
+   template <typename FN>
+   bool one_sided(RangeStats& range, FN&& operation) {
+      if (range.points == Route::STORAGE && range.operations % ROUTER_PROBE != 0) return false;
+      auto& contention = threads::onesided::Worker::my().contention;
+      auto before = contention.total();
+      operation();
+      range.measured++;
+      range.contention += contention.total() - before;
+      return true;
+   }
+
+   bool lookup(Key key, Value& retValue) {
+      auto& range = range_of(key);
+      bool found = false;
+      if (!one_sided(range, [&]() { found = hybrid.tree.lookup(key, retValue); })) {
+         storage_scan(key, key, 1, [&](const Key&, const Value& value) {
+            retValue = value;
+            found = true;
+         });
+      }
+      decide(range);
+      return found;
+   }
+
+   void insert(Key key, Value value) {
+      auto& range = range_of(key);
+      if (!one_sided(range, [&]() { hybrid.tree.insert(key, value); })) {
+         // full leaves are split one-sided
+         auto& worker = threads::onesided::Worker::my();
+         if (!worker.leaf_insert(hybrid.locate_leaf(key), key, value)) hybrid.tree.insert(key, value);
+      }
+      decide(range);
+   }
+
+   template <typename FN>
+   void range_scan(const Key from, const Key to, FN scan_function) {
+      auto& range = range_of(from);
+      uint64_t rows = 0;
+      auto count = [&](Key& key, Value& value) {
+         rows++;
+         scan_function(key, value);
+      };
+      if (range.scans == Route::STORAGE)
+         storage_scan(from, to, ALL_ROWS, count);
+      else
+         hybrid.tree.range_scan(from, to, count);
+      range.scans_seen++;
+      range.rows += rows;
+      decide(range);
+   }
+
+   // rows are delivered in key order, at most limit of them. One request per storage node the scan reaches and per
+   // MAX_SCAN_RESULT rows, the size of the result buffer
+   template <typename FN>
+   void storage_scan(const Key from, const Key to, uint64_t limit, FN&& scan_function) {
+      auto& worker = threads::onesided::Worker::my();
+      auto start = hybrid.tree.metadata;
+      bool from_metadata = true;
+      auto resume = from;
+      for (;;) {
+         std::span<KVPair> rows;
+         auto page_rows = std::min<uint64_t>(limit, MAX_SCAN_RESULT);
+         auto response = worker.tree_scan(start, from_metadata, resume, to, page_rows, rows);
+         if (response.rc == rdma::RESULT::ABORTED) {
+            start = hybrid.tree.metadata;
+            from_metadata = true;
+            continue;
+         }
+         for (auto& row : rows) {
+            Key key = row.key;
+            Value value = row.value;
+            scan_function(key, value);
+         }
+         if (limit != ALL_ROWS) limit -= rows.size();
+         if (!response.has_more || limit == 0) return;
+         start = RemotePtr(response.next);
+         from_metadata = false;
+         resume = response.resume;
+      }
+   }
+};
+}  // namespace onesided
+}  // namespace dtree
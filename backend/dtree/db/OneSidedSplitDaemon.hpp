@@ -0,0 +1,115 @@
+#pragma once
+#include <immintrin.h>
+
+#include <atomic>
+#include <cstdint>
+
+#include "Defs.hpp"
+#include "OneSidedBTree.hpp"
+#include "OneSidedStorageOps.hpp"
+#include "OneSidedTypes.hpp"
+//=== Storage-side split daemon of the one-sided tree ===//
+// consumes the split hints of the compute nodes and splits the announced node before it is full, so that inserts
+// rarely find a full node and hold two remote latches across the round trips of a split. Parent, node and the new
+// right node must be local; everything else, including busy and replicated nodes, is skipped since hints are best
+// effort.
+
+namespace dtree {
+namespace onesided {
+
+template <typename Key, typename Value, typename LeafT = ActiveLeaf<Key, Value>>
+struct SplitDaemon {
+   using Tree = BTree<Key, Value, LeafT>;
+   using Leaf = LeafT;
+   using Inner = BTreeInner<Key>;
+   SplitHintRing& ring;
+   NodeID node_id;
+   uint64_t& page_counter;  // pages handed out of node_buffer, shared with the FAAs of the compute nodes
+   uint8_t* node_buffer;
+   uint64_t tail{0};
+   uint64_t splits{0};
+
+   SplitDaemon(SplitHintRing& ring, NodeID node_id, uint64_t& page_counter, uint8_t* node_buffer)
+       : ring(ring), node_id(node_id), page_counter(page_counter), node_buffer(node_buffer) {}
+
+   RemotePtr allocate_page() {
+      auto p_idx = std::atomic_ref<uint64_t>(page_counter).fetch_add(1);
+      return RemotePtr(node_id, (p_idx * BTREE_NODE_SIZE) + reinterpret_cast<uintptr_t>(node_buffer));
+   }
+
+   static bool is_child(Inner* parent, RemotePtr node) {
+      for (Pos c_i = 0; c_i <= parent->end(); c_i++) {
+         if (parent->children[c_i] == node) return true;
+      }
+      return false;
+   }
+   // the parent is latched anyway: a leaf that is not split gets a fill hint for its current count
+   static void refresh_fill_hint(Inner* parent, RemotePtr leaf, Pos count) {
+      for (Pos c_i = 0; c_i <= parent->end(); c_i++) {
+         if (parent->children[c_i] == leaf) parent->fill_hints[c_i] = Tree::fill_hint(count);
+      }
+   }
+   // both are latched; the node may have been split by a compute node since the hint was posted
+   template <typename T>
+   bool split_child(Inner* parent, T* node, RemotePtr node_ptr) {
+      if (node->count + SPLIT_HINT_SLACK < T::max_entries || node->retired) return false;
+      auto right_ptr = allocate_page();
+      auto* right = local_page<T>(right_ptr);
+      allocateInRDMARegion<T>(right);  // unreachable until the parent is unlatched
+      auto sepInfo = node->split_into(right, right_ptr);
+      if constexpr (std::is_same_v<T, Inner>) {
+         parent->insert(sepInfo.sep, node_ptr, right_ptr);
+      } else {
+         parent->insert(sepInfo.sep, node_ptr, right_ptr, Tree::fill_hint(node->count),
+                        Tree::fill_hint(sepInfo.rightCount));
+      }
+      return true;
+   }
+   // returns true if the announced node was split
+   bool process(const SplitHint& hint) {
+      RemotePtr parent_ptr(hint.parent);
+      RemotePtr node_ptr(hint.node);
+      if (parent_ptr.getOwner() != node_id || node_ptr.getOwner() != node_id) return false;
+      auto* parent = local_page<Inner>(parent_ptr);
+      if (!LocalLatch::try_latch(parent)) return false;  // busy nodes are left to the compute nodes
+      bool split = false;
+      if (parent->getNodeType() == BTreeNodeType::INNER && !parent->replicated() && parent->has_space() &&
+          is_child(parent, node_ptr)) {
+         auto* node = local_page<NodePlaceholder>(node_ptr);
+         if (LocalLatch::try_latch(node)) {
+            if (node->getNodeType() == BTreeNodeType::LEAF) {
+               split = split_child(parent, node->as<Leaf>(), node_ptr);
+               if (!split) refresh_fill_hint(parent, node_ptr, node->count);
+            } else if (!node->as<Inner>()->replicated())
+               split = split_child(parent, node->as<Inner>(), node_ptr);
+            LocalLatch::unlatch(node, split);
+         }
+      }
+      LocalLatch::unlatch(parent, split);
+      return split;
+   }
+
+   // idle is called whenever no hint is pending
+   template <typename IDLE>
+   void run(std::atomic<bool>& running, IDLE&& idle) {
+      while (running) {
+         auto head = std::atomic_ref<uint64_t>(ring.head).load(std::memory_order_acquire);
+         if (head - tail > SPLIT_HINT_SLOTS) tail = head - SPLIT_HINT_SLOTS;  // overtaken, the oldest hints are lost
+         if (tail == head) {
+            idle();
+            _mm_pause();
+            continue;
+         }
+         auto& slot = ring.slots[tail % SPLIT_HINT_SLOTS];
+         auto seq = std::atomic_ref<uint64_t>(slot.seq).load(std::memory_order_acquire);
+         if (seq < tail + 1) {  // position reserved but not written yet
+            _mm_pause();
+            continue;
+         }
+         if (seq == tail + 1 && process({slot.parent, slot.node, seq})) splits++;
+         tail++;  // a larger seq means the slot was already reused
+      }
+   }
+};
+}  // namespace onesided
+}  // namespace dtree
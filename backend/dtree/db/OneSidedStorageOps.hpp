@@ -0,0 +1,201 @@
+#pragma once
+#include <immintrin.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cstdint>
+
+#include "Defs.hpp"
+#include "OneSidedBTree.hpp"
+#include "OneSidedTypes.hpp"
+//=== Operations of storage nodes on their own one-sided pages ===//
+// storage nodes latch their pages with CPU atomics on the same latch word the compute nodes CAS remotely and follow
+// the version protocol of GuardX, hence one-sided readers and writers stay consistent. CPU atomics are only atomic
+// with respect to RDMA atomics if the NIC supports global atomicity (IBV_ATOMIC_GLOB).
+
+namespace dtree {
+namespace onesided {
+
+struct LocalLatch {
+   // remote writers hold a latch for a few round trips only
+   static constexpr size_t ATTEMPTS{1024};
+   static bool try_latch(PageHeader* page) {
+      uint64_t expected = UNLOCKED;
+      return std::atomic_ref<uint64_t>(page->remote_latch).compare_exchange_strong(expected, EXCLUSIVE_LOCKED);
+   }
+   static bool latch(PageHeader* page) {
+      for (size_t attempt = 0; attempt < ATTEMPTS; attempt++) {
+         if (try_latch(page)) return true;
+         _mm_pause();
+      }
+      return false;
+   }
+   // a modified page gets a new version before it is unlatched; in-place updaters may be backing off concurrently
+   static void unlatch(PageHeader* page, bool modified) {
+      if (modified) page->version++;
+      std::atomic_ref<uint64_t>(page->remote_latch).fetch_sub(EXCLUSIVE_LOCKED, std::memory_order_release);
+   }
+};
+
+template <typename T>
+T* local_page(RemotePtr ptr) {
+   return reinterpret_cast<T*>(ptr.plainOffset());
+}
+
+// upsert into a leaf of this storage node, located by a compute node with one-sided reads. Returns false if the
+// compute node has to insert one-sided: the leaf is busy, full or does not cover the key (any longer)
+template <typename Leaf, typename Key, typename Value>
+bool local_upsert(NodeID self, RemotePtr leaf_ptr, const Key& key, const Value& value) {
+   if (leaf_ptr.getOwner() != self) return false;
+   auto* leaf = local_page<Leaf>(leaf_ptr);
+   if (!LocalLatch::latch(leaf)) return false;
+   auto lower = leaf->fenceKeys.getLower();
+   auto upper = leaf->fenceKeys.getUpper();
+   bool applied = leaf->getNodeType() == BTreeNodeType::LEAF && !leaf->retired &&
+                  (lower.isInfinity || key > lower.key) && (upper.isInfinity || key <= upper.key) &&
+                  leaf->has_space_for(key);
+   if (applied) leaf->upsert(key, value);
+   LocalLatch::unlatch(leaf, applied);
+   return applied;
+}
+
+// optimistic read of a local page: read runs between two checks of latch and version and is repeated while the page
+// changes underneath. read must cope with torn content, which is discarded. Returns false if the page stayed busy
+template <typename FN>
+bool local_read(PageHeader* page, FN&& read) {
+   std::atomic_ref<uint64_t> latch(page->remote_latch);
+   std::atomic_ref<uint64_t> version(page->version);
+   for (size_t attempt = 0; attempt < LocalLatch::ATTEMPTS; attempt++) {
+      if (!exclusively_latched(latch.load(std::memory_order_acquire))) {
+         auto before = version.load(std::memory_order_acquire);
+         read();
+         std::atomic_thread_fence(std::memory_order_acquire);
+         if (!exclusively_latched(latch.load(std::memory_order_relaxed)) &&
+             version.load(std::memory_order_relaxed) == before)
+            return true;
+      }
+      _mm_pause();
+   }
+   return false;
+}
+
+// end of a descent on a storage node
+struct Descent {
+   RemotePtr node{NULL_REMOTEPTR};
+   bool leaf{false};   // node is the leaf covering the key, otherwise the next node on the path owned by another node
+   bool valid{false};  // false if a node stayed busy or start no longer covers the key
+};
+
+// descends from start (a node or the metadata page) towards key as long as the nodes are local. Every node is read
+// optimistically and must cover the key, hence a node split after its parent was read ends the descent as invalid.
+// The leaf itself is not read; whoever reads it checks that it still covers the key
+template <typename Key>
+Descent local_descend(NodeID self, RemotePtr start, bool from_metadata, const Key& key) {
+   using Inner = BTreeInner<Key>;
+   Descent descent;
+   auto node = start;
+   if (from_metadata) {
+      auto* md = local_page<MetadataPage>(start);
+      if (start.getOwner() != self || !local_read(md, [&]() { node = md->getRootPtr(); })) return descent;
+   }
+   while (node.getOwner() == self) {
+      auto* page = local_page<NodePlaceholder>(node);
+      bool leaf = false;
+      bool covers = false;
+      uint8_t level = 0;
+      RemotePtr child = NULL_REMOTEPTR;
+      auto read = [&]() {
+         leaf = page->getNodeType() == BTreeNodeType::LEAF;
+         if (leaf) return;
+         auto* inner = page->as<Inner>();
+         auto lower = inner->fenceKeys.getLower();
+         auto upper = inner->fenceKeys.getUpper();
+         covers = (lower.isInfinity || key > lower.key) && (upper.isInfinity || key <= upper.key) &&
+                  inner->count <= Inner::max_entries;
+         if (!covers) return;
+         level = inner->level;
+         child = inner->next_child(key);
+      };
+      if (!local_read(page, read)) return descent;
+      if (leaf) return {node, true, true};  // the root or a start node that is a leaf
+      if (!covers) return descent;
+      if (level == 1) return {child, true, true};
+      node = child;
+   }
+   return {node, false, true};
+}
+
+// rows of a scan executed on a storage node
+struct LocalScan {
+   uint64_t length{0};
+   bool has_more{false};  // continue from resume at next
+   RemotePtr next{NULL_REMOTEPTR};
+   Key resume{};
+   bool valid{false};  // false if nothing was scanned and the scan has to start over at the metadata page
+};
+
+// copies the entries of [from, to] into out, starting with a descent from start (see local_descend) and following
+// the right links while the leaves are local. A leaf is only handed out after it validated; at most limit rows
+template <typename Leaf>
+LocalScan local_scan(NodeID self, RemotePtr start, bool from_metadata, Key from, const Key to, uint64_t limit,
+                     KVPair* out) {
+   ensure(limit > 0);
+   LocalScan scan;
+   auto descent = local_descend(self, start, from_metadata, from);
+   if (!descent.valid) return scan;
+   scan.valid = true;
+   auto stop = [&](RemotePtr next) {
+      scan.has_more = true;
+      scan.next = next;
+      scan.resume = from;
+      return scan;
+   };
+   if (!descent.leaf || descent.node.getOwner() != self) return stop(descent.node);
+   std::array<KVPair, Leaf::max_entries> staged;
+   for (auto leaf_ptr = descent.node;;) {
+      auto* leaf = local_page<Leaf>(leaf_ptr);
+      Pos staged_count = 0;
+      bool usable = false;
+      bool finished = false;
+      Key upper_key{};
+      RemotePtr right = NULL_REMOTEPTR;
+      auto read = [&]() {
+         staged_count = 0;
+         auto lower = leaf->fenceKeys.getLower();
+         auto upper = leaf->fenceKeys.getUpper();
+         usable = leaf->getNodeType() == BTreeNodeType::LEAF && !leaf->retired && leaf->count <= Leaf::max_entries &&
+                  (lower.isInfinity || from > lower.key) && (upper.isInfinity || from <= upper.key);
+         if (!usable) return;
+         finished = upper.isInfinity || upper.key >= to;
+         upper_key = upper.key;
+         right = leaf->getRightLink();
+         for (Pos it = leaf->lower_bound(from); it != leaf->end(); it++) {
+            auto key = leaf->key_at(it);
+            if (key > to) {
+               finished = true;
+               break;
+            }
+            staged[staged_count++] = {key, leaf->value_at(it)};
+         }
+      };
+      if (!local_read(leaf, read) || !usable) {
+         // reached through a right link: the rows so far are valid, the next request starts over
+         if (scan.length == 0) scan.valid = false;
+         return stop(leaf_ptr);
+      }
+      auto copy = std::min<uint64_t>(staged_count, limit - scan.length);
+      std::copy(staged.begin(), staged.begin() + copy, out + scan.length);
+      scan.length += copy;
+      if (copy < staged_count) {
+         from = out[scan.length - 1].key + 1;  // below a staged key <= to
+         return stop(leaf_ptr);
+      }
+      if (finished) return scan;
+      from = upper_key + 1;  // upper_key < to
+      leaf_ptr = right;
+      if (scan.length == limit || leaf_ptr.getOwner() != self) return stop(leaf_ptr);
+   }
+}
+}  // namespace onesided
+}  // namespace dtree
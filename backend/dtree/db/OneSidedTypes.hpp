@@ -17,9 +17,13 @@
 namespace dtree {
 namespace onesided {
 
+// latch word of a page: the exclusive bit plus, in the low bits, the number of in-place updaters and shared readers of
+// a leaf. Both register with an FAA and back off if the bit is set, hence the bit is only taken (CAS) when there are
+// none and is cleared with an FAA that leaves the transient registrations of backing off updaters and readers intact
 static constexpr uint64_t EXCLUSIVE_LOCKED = 0x1000000000000000;
 static constexpr uint64_t EXCLUSIVE_UNLOCK_TO_BE_ADDED = 0xFFFFFFFFFFFFFFFF - EXCLUSIVE_LOCKED + 1;
 static constexpr uint64_t UNLOCKED = 0;
+inline bool exclusively_latched(uint64_t latch) { return (latch & EXCLUSIVE_LOCKED) != 0; }
 
 using Version = uint64_t;
 
@@ -35,6 +39,14 @@ enum class PType_t : uint8_t {
    METADATA = 1,
    BTREE_NODE = 2,
 };
+// storage node of the page created by a split
+enum class AllocationPolicy : uint8_t {
+   RANDOM = 0,        // shuffled pages of all storage nodes
+   SIBLING = 1,       // node of the page being split, neighboring leaves stay on one node
+   PARENT = 2,        // node of the parent of the page being split
+   ROUND_ROBIN = 3,   // per worker
+   LEAST_LOADED = 4,  // fewest allocated pages as last observed by this worker
+};
 // attention must be cacheline aligned! but alignas will negatively impact size
 // therefore pay attention at alloc;
 constexpr size_t BUFFER_SIZE = 15;
@@ -51,7 +63,7 @@ struct PageHeader {
    };
    struct BTreeHeaderPiggyback {
       BTreeNodeType node_type;
-      uint16_t count;
+      RemotePtr right_link;  // right sibling on the same level, maintained by splits
    };
 
    union {
@@ -70,6 +82,18 @@ struct MetadataPage : public PageHeader {
 };
 static_assert(sizeof(PageHeader) <= 64, "PageHeader larger than CL");
 
+// a node that filled up below parent, written by compute nodes with one WRITE into the ring of the storage node that
+// owns the parent. seq is the last word of the slot and marks it as written
+struct SplitHint {
+   uint64_t parent;
+   uint64_t node;
+   uint64_t seq;  // ring position + 1
+};
+struct SplitHintRing {
+   uint64_t head{0};  // next ring position, FAA by compute nodes
+   SplitHint slots[SPLIT_HINT_SLOTS]{};
+};
+
 template <class T, typename... Params>
 void allocateInRDMARegion(T* ptr, Params&&... params) {
    new (ptr) T(std::forward<Params>(params)...);
@@ -0,0 +1,655 @@
+#pragma once
+#include <immintrin.h>
+
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <cassert>
+#include <cstdint>
+#include <cstring>
+#include <string_view>
+
+#include "Defs.hpp"
+#include "btree.hpp"
+
+//=== Two-sided B+Tree with variable-length keys ===//
+// Slotted pages with prefix truncation; used by the message handlers on the storage node
+
+namespace twosided {
+
+// 64 byte keys need more room than pageSize to keep a reasonable fanout
+static constexpr uint64_t varPageSize = 4 * 1024;
+
+struct VarKey {
+   uint16_t length{0};
+   std::array<uint8_t, MAX_VAR_KEY_LENGTH> data;
+
+   VarKey() = default;
+   VarKey(std::string_view key) { assign(key); }
+   void assign(std::string_view key) {
+      ensure(key.size() <= MAX_VAR_KEY_LENGTH);
+      length = static_cast<uint16_t>(key.size());
+      std::memcpy(data.data(), key.data(), key.size());
+   }
+   void assign(const uint8_t* prefix, unsigned prefixLength, const uint8_t* suffix, unsigned suffixLength) {
+      ensure(prefixLength + suffixLength <= MAX_VAR_KEY_LENGTH);
+      std::memcpy(data.data(), prefix, prefixLength);
+      std::memcpy(data.data() + prefixLength, suffix, suffixLength);
+      length = static_cast<uint16_t>(prefixLength + suffixLength);
+   }
+   std::string_view view() const { return {reinterpret_cast<const char*>(data.data()), length}; }
+};
+
+struct VarFence {
+   bool isInfinity = true;
+   std::string_view key;
+};
+
+struct VarNodeHeader : public NodeBase {
+   struct FenceSlot {
+      uint16_t offset{0};
+      uint16_t length{0};
+      bool isInfinity{true};
+   };
+   NodeBase* upper{nullptr};  // rightmost child of inner nodes
+   FenceSlot lowerFence;      // exclusive
+   FenceSlot upperFence;      // inclusive
+   uint16_t payloadLength{0};
+   uint16_t spaceUsed{0};  // heap bytes incl. fences
+   uint16_t dataOffset{varPageSize};
+   uint16_t prefixLength{0};  // common prefix of the fences, truncated from all keys
+};
+
+// Slots grow from the front, keys and payloads from the back of the page.
+// A slot stores the key suffix (without prefix) followed by the payload: Value in leaves, child pointer in inner nodes.
+struct VarNode : public VarNodeHeader {
+   struct Slot {
+      uint16_t offset;
+      uint16_t keyLength;  // without prefix
+      uint32_t head;       // first suffix bytes in big endian, avoids most key comparisons
+   };
+   static constexpr uint64_t maxSlots = (varPageSize - sizeof(VarNodeHeader)) / sizeof(Slot);
+   union {
+      Slot slot[maxSlots];
+      uint8_t heap[varPageSize - sizeof(VarNodeHeader)];
+   };
+
+   VarNode(PageType pageType, uint16_t payloadLength_) {
+      static_assert(sizeof(VarNode) == varPageSize, "var node size problem");
+      count = 0;
+      type = pageType;
+      payloadLength = payloadLength_;
+   }
+
+   bool isLeaf() { return type == PageType::BTreeLeaf; }
+   uint8_t* ptr() { return reinterpret_cast<uint8_t*>(this); }
+   uint8_t* getLowerFence() { return ptr() + lowerFence.offset; }
+   uint8_t* getUpperFence() { return ptr() + upperFence.offset; }
+   uint8_t* getPrefix() { return getLowerFence(); }  // prefix is shared by both fences
+   VarFence lowerFenceView() {
+      return {lowerFence.isInfinity, {reinterpret_cast<char*>(getLowerFence()), lowerFence.length}};
+   }
+   VarFence upperFenceView() {
+      return {upperFence.isInfinity, {reinterpret_cast<char*>(getUpperFence()), upperFence.length}};
+   }
+   uint8_t* getKey(unsigned slotId) { return ptr() + slot[slotId].offset; }
+   uint8_t* getPayload(unsigned slotId) { return getKey(slotId) + slot[slotId].keyLength; }
+   NodeBase* getChild(unsigned slotId) {
+      NodeBase* child;
+      std::memcpy(&child, getPayload(slotId), sizeof(NodeBase*));
+      return child;
+   }
+   void setChild(unsigned slotId, NodeBase* child) { std::memcpy(getPayload(slotId), &child, sizeof(NodeBase*)); }
+   void fullKey(unsigned slotId, VarKey& out) { out.assign(getPrefix(), prefixLength, getKey(slotId), slot[slotId].keyLength); }
+   // -------------------------------------------------------------------------------------
+   unsigned freeSpace() { return dataOffset - static_cast<unsigned>(reinterpret_cast<uint8_t*>(slot + count) - ptr()); }
+   unsigned freeSpaceAfterCompaction() {
+      return static_cast<unsigned>(varPageSize - (reinterpret_cast<uint8_t*>(slot + count) - ptr()) - spaceUsed);
+   }
+   unsigned spaceNeeded(unsigned keyLength) { return static_cast<unsigned>(sizeof(Slot)) + keyLength - prefixLength + payloadLength; }
+   bool hasSpaceFor(unsigned keyLength) { return spaceNeeded(keyLength) <= freeSpaceAfterCompaction(); }
+   // -------------------------------------------------------------------------------------
+   static uint32_t head(const uint8_t* key, unsigned keyLength) {
+      uint8_t bytes[sizeof(uint32_t)] = {0, 0, 0, 0};
+      std::memcpy(bytes, key, std::min<unsigned>(keyLength, sizeof(uint32_t)));
+      return (uint32_t(bytes[0]) << 24) | (uint32_t(bytes[1]) << 16) | (uint32_t(bytes[2]) << 8) | uint32_t(bytes[3]);
+   }
+   static int cmpKeys(const uint8_t* a, unsigned aLength, const uint8_t* b, unsigned bLength) {
+      int c = std::memcmp(a, b, std::min(aLength, bLength));
+      if (c) return c;
+      return (aLength < bLength) ? -1 : (aLength > bLength);
+   }
+   static unsigned commonPrefix(const uint8_t* a, unsigned aLength, const uint8_t* b, unsigned bLength) {
+      unsigned limit = std::min(aLength, bLength);
+      unsigned i = 0;
+      while (i < limit && a[i] == b[i]) i++;
+      return i;
+   }
+   // slot key length clamped to the page; optimistic readers may see torn slots
+   unsigned boundedKeyLength(unsigned slotId) {
+      unsigned offset = std::min<unsigned>(slot[slotId].offset, varPageSize);
+      return std::min<unsigned>(slot[slotId].keyLength, static_cast<unsigned>(varPageSize) - offset);
+   }
+   // copies of key and payload of slotId that stay within the page and MAX_VAR_KEY_LENGTH however torn the node is,
+   // the copy is only meaningful once the reader validated the version
+   template <class Value>
+   void copyEntry(unsigned slotId, VarKey& key, Value& value) {
+      unsigned offset = std::min<unsigned>(slot[slotId].offset, varPageSize);
+      unsigned suffixLength = boundedKeyLength(slotId);
+      boundedCopy(lowerFence.offset, prefixLength, ptr() + offset, suffixLength, key);
+      unsigned payload = std::min<unsigned>(offset + suffixLength, static_cast<unsigned>(varPageSize - sizeof(Value)));
+      std::memcpy(&value, ptr() + payload, sizeof(Value));
+   }
+   void copyUpperFence(VarKey& key) { boundedCopy(upperFence.offset, upperFence.length, nullptr, 0, key); }
+   void boundedCopy(unsigned prefixOffset, unsigned prefixLength_, const uint8_t* suffix, unsigned suffixLength,
+                    VarKey& key) {
+      prefixOffset = std::min<unsigned>(prefixOffset, varPageSize);
+      unsigned prefix = std::min<unsigned>({prefixLength_, static_cast<unsigned>(MAX_VAR_KEY_LENGTH),
+                                            static_cast<unsigned>(varPageSize) - prefixOffset});
+      key.assign(ptr() + prefixOffset, prefix, suffix, std::min<unsigned>(suffixLength, MAX_VAR_KEY_LENGTH - prefix));
+   }
+   // -------------------------------------------------------------------------------------
+   // finds the first key which matches key if exists
+   // otherwise returns next larger key
+   unsigned lowerBound(std::string_view key, bool& found) {
+      found = false;
+      auto* k = reinterpret_cast<const uint8_t*>(key.data());
+      unsigned keyLength = static_cast<unsigned>(key.size());
+      // keys within the fences share the prefix, others are outside of this node
+      int c = std::memcmp(k, getPrefix(), std::min<unsigned>(keyLength, prefixLength));
+      if (c < 0 || (c == 0 && keyLength < prefixLength)) return 0;
+      unsigned n = std::min<unsigned>(count, maxSlots);
+      if (c > 0) return n;
+      k += prefixLength;
+      keyLength -= prefixLength;
+      uint32_t h = head(k, keyLength);
+      unsigned lower = 0;
+      unsigned upper = n;
+      while (lower < upper) {
+         unsigned mid = ((upper - lower) / 2) + lower;
+         if (h < slot[mid].head) {
+            upper = mid;
+         } else if (h > slot[mid].head) {
+            lower = mid + 1;
+         } else {
+            int cmp = cmpKeys(k, keyLength, getKey(mid), boundedKeyLength(mid));
+            if (cmp < 0) {
+               upper = mid;
+            } else if (cmp > 0) {
+               lower = mid + 1;
+            } else {
+               found = true;
+               return mid;
+            }
+         }
+      }
+      return lower;
+   }
+   // finds the first key which is larger than key
+   unsigned upperBound(std::string_view key) {
+      bool found;
+      unsigned pos = lowerBound(key, found);
+      return found ? pos + 1 : pos;
+   }
+   NodeBase* lookupInner(std::string_view key, bool upperBoundSearch = false) {
+      bool found;
+      unsigned pos = upperBoundSearch ? upperBound(key) : lowerBound(key, found);
+      if (pos >= count) return upper;
+      return getChild(pos);
+   }
+   // -------------------------------------------------------------------------------------
+   void storeKeyValue(unsigned slotId, const uint8_t* suffix, unsigned suffixLength, const uint8_t* payload) {
+      slot[slotId].head = head(suffix, suffixLength);
+      slot[slotId].keyLength = static_cast<uint16_t>(suffixLength);
+      auto space = static_cast<uint16_t>(suffixLength + payloadLength);
+      dataOffset = static_cast<uint16_t>(dataOffset - space);
+      spaceUsed = static_cast<uint16_t>(spaceUsed + space);
+      slot[slotId].offset = dataOffset;
+      std::memcpy(getKey(slotId), suffix, suffixLength);
+      std::memcpy(getPayload(slotId), payload, payloadLength);
+   }
+   // copies n entries to dst; keys are re-truncated to the prefix of dst
+   void copyKeyValueRange(VarNode* dst, unsigned dstSlot, unsigned srcSlot, unsigned n) {
+      VarKey key;
+      for (unsigned i = 0; i < n; i++) {
+         fullKey(srcSlot + i, key);
+         dst->storeKeyValue(dstSlot + i, key.data.data() + dst->prefixLength, key.length - dst->prefixLength,
+                            getPayload(srcSlot + i));
+      }
+   }
+   void insertFence(FenceSlot& fence, VarFence key) {
+      fence.isInfinity = key.isInfinity;
+      if (key.isInfinity) {
+         fence.offset = 0;
+         fence.length = 0;
+         return;
+      }
+      auto length = static_cast<uint16_t>(key.key.size());
+      dataOffset = static_cast<uint16_t>(dataOffset - length);
+      spaceUsed = static_cast<uint16_t>(spaceUsed + length);
+      fence.offset = dataOffset;
+      fence.length = length;
+      std::memcpy(ptr() + dataOffset, key.key.data(), length);
+   }
+   // only valid on an empty node
+   void setFences(VarFence lower, VarFence upper_) {
+      insertFence(lowerFence, lower);
+      insertFence(upperFence, upper_);
+      prefixLength = 0;
+      if (!lower.isInfinity && !upper_.isInfinity)
+         prefixLength = static_cast<uint16_t>(commonPrefix(getLowerFence(), lowerFence.length, getUpperFence(), upperFence.length));
+   }
+   // overwrites everything except the latch; the node must be write locked
+   void replaceWith(VarNode& other) {
+      std::memcpy(ptr() + sizeof(OptLock), other.ptr() + sizeof(OptLock), varPageSize - sizeof(OptLock));
+   }
+   void compactify() {
+      VarNode tmp(type, payloadLength);
+      tmp.setFences(lowerFenceView(), upperFenceView());
+      copyKeyValueRange(&tmp, 0, 0, count);
+      tmp.count = count;
+      tmp.upper = upper;
+      replaceWith(tmp);
+   }
+   void requestSpace(unsigned space) {
+      if (space <= freeSpace()) return;
+      ensure(space <= freeSpaceAfterCompaction());
+      compactify();
+   }
+   // -------------------------------------------------------------------------------------
+   // inserts or overwrites the payload of an existing key
+   void insert(std::string_view key, const uint8_t* payload) {
+      bool found;
+      unsigned pos = lowerBound(key, found);
+      if (found) {
+         std::memcpy(getPayload(pos), payload, payloadLength);
+         return;
+      }
+      requestSpace(spaceNeeded(static_cast<unsigned>(key.size())));
+      std::memmove(slot + pos + 1, slot + pos, sizeof(Slot) * (count - pos));
+      storeKeyValue(pos, reinterpret_cast<const uint8_t*>(key.data()) + prefixLength,
+                    static_cast<unsigned>(key.size()) - prefixLength, payload);
+      count++;
+   }
+   // after splitting the child left, the entry which pointed to left covers (sep, old] and points to right
+   void insertChild(std::string_view sep, NodeBase* left, NodeBase* right) {
+      bool found;
+      unsigned pos = lowerBound(sep, found);
+      if (pos == count)
+         upper = right;
+      else
+         setChild(pos, right);
+      insert(sep, reinterpret_cast<const uint8_t*>(&left));
+   }
+   bool remove(std::string_view key) {
+      bool found;
+      unsigned pos = lowerBound(key, found);
+      if (!found) return false;
+      spaceUsed = static_cast<uint16_t>(spaceUsed - (slot[pos].keyLength + payloadLength));
+      std::memmove(slot + pos, slot + pos + 1, sizeof(Slot) * (count - pos - 1));
+      count--;
+      return true;
+   }
+   // -------------------------------------------------------------------------------------
+   // leaves pick the pair with the shortest distinguishing prefix around the middle
+   unsigned findSeparator() {
+      ensure(count > 1);
+      if (!isLeaf()) return count / 2;
+      unsigned mid = count / 2;
+      unsigned window = std::max(1u, static_cast<unsigned>(count) / 16);
+      unsigned best = mid - 1;
+      unsigned bestLength = ~0u;
+      for (unsigned s = (mid > window) ? mid - window : 0; s <= mid + window && s + 1 < count; s++) {
+         unsigned length = commonPrefix(getKey(s), slot[s].keyLength, getKey(s + 1), slot[s + 1].keyLength);
+         if (length < bestLength) {
+            bestLength = length;
+            best = s;
+         }
+      }
+      return best;
+   }
+   // leaves: shortest key sep with left <= sep < right (upper fences are inclusive)
+   // inner nodes: the key at sepSlot moves up
+   void getSeparator(unsigned sepSlot, VarKey& sep) {
+      if (!isLeaf()) {
+         fullKey(sepSlot, sep);
+         return;
+      }
+      VarKey right;
+      fullKey(sepSlot, sep);
+      fullKey(sepSlot + 1, right);
+      unsigned common = commonPrefix(sep.data.data(), sep.length, right.data.data(), right.length);
+      if (right.length > common + 1) sep.assign(right.view().substr(0, common + 1));
+   }
+   VarNode* split(VarKey& sep) {
+      unsigned sepSlot = findSeparator();
+      getSeparator(sepSlot, sep);
+      VarFence sepFence{.isInfinity = false, .key = sep.view()};
+      auto* right = new VarNode(type, payloadLength);
+      VarNode left(type, payloadLength);
+      left.setFences(lowerFenceView(), sepFence);
+      right->setFences(sepFence, upperFenceView());
+      if (isLeaf()) {
+         copyKeyValueRange(&left, 0, 0, sepSlot + 1);
+         copyKeyValueRange(right, 0, sepSlot + 1, count - sepSlot - 1);
+         left.count = static_cast<uint16_t>(sepSlot + 1);
+         right->count = static_cast<uint16_t>(count - sepSlot - 1);
+      } else {
+         copyKeyValueRange(&left, 0, 0, sepSlot);
+         copyKeyValueRange(right, 0, sepSlot + 1, count - sepSlot - 1);
+         left.count = static_cast<uint16_t>(sepSlot);
+         right->count = static_cast<uint16_t>(count - sepSlot - 1);
+         left.upper = getChild(sepSlot);
+         right->upper = upper;
+      }
+      replaceWith(left);
+      return right;
+   }
+};
+
+template <class Value>
+struct VarKeyBTree {
+   std::atomic<NodeBase*> root;
+   VarKeyBTree() { root = new VarNode(PageType::BTreeLeaf, sizeof(Value)); }
+   void makeRoot(std::string_view sep, NodeBase* leftChild, NodeBase* rightChild) {
+      auto inner = new VarNode(PageType::BTreeInner, sizeof(NodeBase*));
+      inner->upper = rightChild;
+      inner->insert(sep, reinterpret_cast<const uint8_t*>(&leftChild));
+      root = inner;
+   }
+
+   void yield(int count) {
+      (void)count;
+      _mm_pause();
+   }
+
+   void insert(std::string_view k, Value v) {
+      ensure(k.size() <= MAX_VAR_KEY_LENGTH);
+      int restartCount = 0;
+   restart:
+      if (restartCount++) yield(restartCount);
+      bool needRestart = false;
+
+      // Current node
+      NodeBase* node = root;
+      uint64_t versionNode = node->readLockOrRestart(needRestart);
+      if (needRestart || (node != root)) goto restart;
+
+      // Parent of current node
+      VarNode* parent = nullptr;
+      uint64_t versionParent = 0;
+
+      while (node->type == PageType::BTreeInner) {
+         auto inner = static_cast<VarNode*>(node);
+
+         // Split eagerly if a maximal separator does not fit
+         if (!inner->hasSpaceFor(MAX_VAR_KEY_LENGTH)) {
+            // Lock
+            if (parent) {
+               parent->upgradeToWriteLockOrRestart(versionParent, needRestart);
+               if (needRestart) goto restart;
+            }
+            node->upgradeToWriteLockOrRestart(versionNode, needRestart);
+            if (needRestart) {
+               if (parent) parent->writeUnlock();
+               goto restart;
+            }
+            if (!parent && (node != root)) {  // there's a new parent
+               node->writeUnlock();
+               goto restart;
+            }
+            // Split
+            VarKey sep;
+            VarNode* newInner = inner->split(sep);
+            if (parent)
+               parent->insertChild(sep.view(), inner, newInner);
+            else
+               makeRoot(sep.view(), inner, newInner);
+            // Unlock and restart
+            node->writeUnlock();
+            if (parent) parent->writeUnlock();
+            goto restart;
+         }
+
+         if (parent) {
+            parent->readUnlockOrRestart(versionParent, needRestart);
+            if (needRestart) goto restart;
+         }
+
+         parent = inner;
+         versionParent = versionNode;
+
+         node = inner->lookupInner(k);
+         inner->checkOrRestart(versionNode, needRestart);
+         if (needRestart) goto restart;
+         versionNode = node->readLockOrRestart(needRestart);
+         if (needRestart) goto restart;
+      }
+
+      auto leaf = static_cast<VarNode*>(node);
+
+      // Split leaf if full
+      if (!leaf->hasSpaceFor(static_cast<unsigned>(k.size()))) {
+         // Lock
+         if (parent) {
+            parent->upgradeToWriteLockOrRestart(versionParent, needRestart);
+            if (needRestart) goto restart;
+         }
+         node->upgradeToWriteLockOrRestart(versionNode, needRestart);
+         if (needRestart) {
+            if (parent) parent->writeUnlock();
+            goto restart;
+         }
+         if (!parent && (node != root)) {  // there's a new parent
+            node->writeUnlock();
+            goto restart;
+         }
+         // Split
+         VarKey sep;
+         VarNode* newLeaf = leaf->split(sep);
+         if (parent)
+            parent->insertChild(sep.view(), leaf, newLeaf);
+         else
+            makeRoot(sep.view(), leaf, newLeaf);
+         // Unlock and restart
+         node->writeUnlock();
+         if (parent) parent->writeUnlock();
+         goto restart;
+      } else {
+         // only lock leaf node
+         node->upgradeToWriteLockOrRestart(versionNode, needRestart);
+         if (needRestart) goto restart;
+         if (parent) {
+            parent->readUnlockOrRestart(versionParent, needRestart);
+            if (needRestart) {
+               node->writeUnlock();
+               goto restart;
+            }
+         }
+         leaf->insert(k, reinterpret_cast<const uint8_t*>(&v));
+         node->writeUnlock();
+         return;  // success
+      }
+   }
+
+   bool lookup(std::string_view k, Value& result) {
+      int restartCount = 0;
+   restart:
+      if (restartCount++) yield(restartCount);
+      bool needRestart = false;
+
+      NodeBase* node = root;
+      uint64_t versionNode = node->readLockOrRestart(needRestart);
+      if (needRestart || (node != root)) goto restart;
+
+      // Parent of current node
+      VarNode* parent = nullptr;
+      uint64_t versionParent = 0;
+
+      while (node->type == PageType::BTreeInner) {
+         auto inner = static_cast<VarNode*>(node);
+
+         if (parent) {
+            parent->readUnlockOrRestart(versionParent, needRestart);
+            if (needRestart) goto restart;
+         }
+
+         parent = inner;
+         versionParent = versionNode;
+
+         node = inner->lookupInner(k);
+         inner->checkOrRestart(versionNode, needRestart);
+         if (needRestart) goto restart;
+         versionNode = node->readLockOrRestart(needRestart);
+         if (needRestart) goto restart;
+      }
+
+      auto leaf = static_cast<VarNode*>(node);
+      bool success = false;
+      unsigned pos = leaf->lowerBound(k, success);
+      if (success) std::memcpy(&result, leaf->getPayload(pos), sizeof(Value));
+      if (parent) {
+         parent->readUnlockOrRestart(versionParent, needRestart);
+         if (needRestart) goto restart;
+      }
+      node->readUnlockOrRestart(versionNode, needRestart);
+      if (needRestart) goto restart;
+
+      return success;
+   }
+
+   // underfull nodes are not merged
+   bool remove(std::string_view k) {
+      int restartCount = 0;
+   restart:
+      if (restartCount++) yield(restartCount);
+      bool needRestart = false;
+
+      NodeBase* node = root;
+      uint64_t versionNode = node->readLockOrRestart(needRestart);
+      if (needRestart || (node != root)) goto restart;
+
+      // Parent of current node
+      VarNode* parent = nullptr;
+      uint64_t versionParent = 0;
+
+      while (node->type == PageType::BTreeInner) {
+         auto inner = static_cast<VarNode*>(node);
+
+         if (parent) {
+            parent->readUnlockOrRestart(versionParent, needRestart);
+            if (needRestart) goto restart;
+         }
+
+         parent = inner;
+         versionParent = versionNode;
+
+         node = inner->lookupInner(k);
+         inner->checkOrRestart(versionNode, needRestart);
+         if (needRestart) goto restart;
+         versionNode = node->readLockOrRestart(needRestart);
+         if (needRestart) goto restart;
+      }
+
+      node->upgradeToWriteLockOrRestart(versionNode, needRestart);
+      if (needRestart) goto restart;
+      if (parent) {
+         parent->readUnlockOrRestart(versionParent, needRestart);
+         if (needRestart) {
+            node->writeUnlock();
+            goto restart;
+         }
+      }
+      bool success = static_cast<VarNode*>(node)->remove(k);
+      node->writeUnlock();
+      return success;
+   }
+
+   // -------------------------------------------------------------------------------------
+   // Scan Code
+   // -------------------------------------------------------------------------------------
+   enum class RC : uint8_t { FINISHED = 0, CONTINUE = 2 };
+   struct op_result {
+      RC return_code = RC::FINISHED;
+      VarKey next_sep;  // upper fence of the last leaf, used when scan needs to continue
+   };
+   // ascending scan; func(std::string_view key, Value value) returns false to stop
+   template <class Fn>
+   void scan(std::string_view k, Fn&& func) {
+      bool isFirstTraversal = true;
+      op_result res;
+      res.next_sep.assign(k);
+      do {
+         VarKey from = res.next_sep;
+         res = scan_(from.view(), func, isFirstTraversal);
+         isFirstTraversal = false;  // after the first traversal the fence key is exclusive hence upper bound
+      } while (res.return_code == RC::CONTINUE);
+   }
+   // -------------------------------------------------------------------------------------
+   template <class Fn>
+   op_result scan_(std::string_view k, Fn&& func, bool isFirstTraversal) {
+      std::pair<VarKey, Value> stagedEntries[VarNode::maxSlots];
+      int restartCount = 0;
+   restart:
+      if (restartCount++) yield(restartCount);
+      bool needRestart = false;
+
+      NodeBase* node = root;
+      uint64_t versionNode = node->readLockOrRestart(needRestart);
+      if (needRestart || (node != root)) goto restart;
+
+      // Parent of current node
+      VarNode* parent = nullptr;
+      uint64_t versionParent = 0;
+      // -------------------------------------------------------------------------------------
+      // inner traversal
+      while (node->type == PageType::BTreeInner) {
+         auto inner = static_cast<VarNode*>(node);
+
+         if (parent) {
+            parent->readUnlockOrRestart(versionParent, needRestart);
+            if (needRestart) goto restart;
+         }
+         parent = inner;
+         versionParent = versionNode;
+         node = inner->lookupInner(k, !isFirstTraversal);  // upper or lower bound
+         inner->checkOrRestart(versionNode, needRestart);
+         if (needRestart) goto restart;
+         versionNode = node->readLockOrRestart(needRestart);
+         if (needRestart) goto restart;
+      }
+      // -------------------------------------------------------------------------------------
+      auto leaf = static_cast<VarNode*>(node);
+      // entries are staged and handed out after the validation, a restart must not deliver them twice
+      op_result res;
+      unsigned staged = 0;
+      {
+         bool found;
+         unsigned it = isFirstTraversal ? leaf->lowerBound(k, found) : leaf->upperBound(k);
+         unsigned count = std::min<unsigned>(leaf->count, VarNode::maxSlots);
+         for (; it < count; it++, staged++)
+            leaf->copyEntry(it, stagedEntries[staged].first, stagedEntries[staged].second);
+         if (leaf->upperFence.isInfinity) {
+            res.return_code = RC::FINISHED;
+         } else {
+            res.return_code = RC::CONTINUE;
+            leaf->copyUpperFence(res.next_sep);
+         }
+      }
+      // -------------------------------------------------------------------------------------
+      if (parent) {
+         parent->readUnlockOrRestart(versionParent, needRestart);
+         if (needRestart) goto restart;
+      }
+      node->readUnlockOrRestart(versionNode, needRestart);
+      if (needRestart) goto restart;
+      for (unsigned s_i = 0; s_i < staged; s_i++) {
+         if (!func(stagedEntries[s_i].first.view(), stagedEntries[s_i].second)) {
+            res.return_code = RC::FINISHED;
+            break;
+         }
+      }
+      return res;
+   }
+};
+}  // namespace twosided
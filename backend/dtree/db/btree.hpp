@@ -1,13 +1,17 @@
+#pragma once
 #include <immintrin.h>
 #include <sched.h>
+#include <algorithm>
 #include <atomic>
 #include <cassert>
 #include <csignal>
 #include <cstdint>
 #include <cstring>
 #include <iostream>
+#include <utility>
 #include <vector>
 #include "Defs.hpp"
+#include "dtree/syncprimitives/HybridLatch.hpp"
 
 //=== Two-sided B+Tree ===//
 // This tree is used by the message handlers on the storage node
@@ -18,14 +22,16 @@ enum class PageType : uint8_t { BTreeInner = 1, BTreeLeaf = 2 };
 
 static const uint64_t pageSize = BTREE_NODE_SIZE;
 
+// OLC interface of the tree implemented with the hybrid latch; in addition to optimistic reads and exclusive writes it
+// offers a blocking shared mode which long scans fall back to when optimistic reads keep failing
 struct OptLock {
-   std::atomic<uint64_t> typeVersionLockObsolete{0b100};
+   dtree::storage::HybridLatch latch;
 
-   bool isLocked(uint64_t version) { return ((version & 0b10) == 0b10); }
+   bool isLocked(uint64_t version) { return latch.isLatched(version); }
 
    uint64_t readLockOrRestart(bool& needRestart) {
       uint64_t version;
-      version = typeVersionLockObsolete.load();
+      version = latch.getVersion();
       if (isLocked(version) || isObsolete(version)) {
          _mm_pause();
          needRestart = true;
@@ -43,7 +49,7 @@ struct OptLock {
    }
 
    void upgradeToWriteLockOrRestart(uint64_t& version, bool& needRestart) {
-      if (typeVersionLockObsolete.compare_exchange_strong(version, version + 0b10)) {
+      if (latch.optimisticUpgradeToExclusive(version)) {
          version = version + 0b10;
       } else {
          _mm_pause();
@@ -51,20 +57,34 @@ struct OptLock {
       }
    }
 
-   void writeUnlock() { typeVersionLockObsolete.fetch_add(0b10); }
+   void writeUnlock() { latch.unlatchExclusive(); }
 
    bool isObsolete(uint64_t version) { return (version & 1) == 1; }
 
    void checkOrRestart(uint64_t startRead, bool& needRestart) const { readUnlockOrRestart(startRead, needRestart); }
 
-   void readUnlockOrRestart(uint64_t startRead, bool& needRestart) const { needRestart = (startRead != typeVersionLockObsolete.load()); }
+   void readUnlockOrRestart(uint64_t startRead, bool& needRestart) const { needRestart = (startRead != latch.version.load()); }
 
-   void writeUnlockObsolete() { typeVersionLockObsolete.fetch_add(0b11); }
+   void writeUnlockObsolete() { latch.unlatchExclusiveObsolete(); }
+
+   // shared mode blocks writers; they fail their upgrade and restart
+   void readLockShared() { latch.latchShared(); }
+   void readUnlockShared() { latch.unlatchShared(); }
 };
 
 struct NodeBase : public OptLock {
    PageType type;
+   uint8_t appendStreak{0};  // inserts in a row at the end of the node
    uint16_t count;
+   // after this many appends a split moves a single entry to the new right node instead of half of them
+   static constexpr uint8_t APPEND_STREAK_SPLIT = 8;
+   void trackAppend(bool atEnd) {
+      appendStreak = atEnd ? static_cast<uint8_t>(std::min(appendStreak + 1, 255)) : static_cast<uint8_t>(0);
+   }
+   uint16_t rightSplitCount() {
+      if (appendStreak >= APPEND_STREAK_SPLIT && count > 2) return 1;
+      return static_cast<uint16_t>(count - (count / 2));
+   }
 };
 
 struct BTreeLeafBase : public NodeBase {
@@ -140,10 +160,12 @@ struct BTreeLeaf : public BTreeLeafBase {
    asc_iterator begin() { return asc_iterator(*this, 0); }
    asc_iterator end() { return asc_iterator(*this, count); }
    // -------------------------------------------------------------------------------------
-   static const uint64_t maxEntries = (pageSize - sizeof(NodeBase) - sizeof(FK)) / (sizeof(Key) + sizeof(Payload));
+   static const uint64_t maxEntries =
+       (pageSize - sizeof(NodeBase) - sizeof(FK) - sizeof(BTreeLeaf*)) / (sizeof(Key) + sizeof(Payload));
    static const uint64_t underflowSize = maxEntries / 4;
    // -------------------------------------------------------------------------------------
    FK fenceKeys;
+   BTreeLeaf* next{nullptr};  // right sibling, changed under the write lock of this leaf
    Key keys[maxEntries];
    Payload payloads[maxEntries];
 
@@ -199,6 +221,7 @@ struct BTreeLeaf : public BTreeLeafBase {
             payloads[pos] = p;
             return;
          }
+         trackAppend(pos == count);
          memmove(keys + pos + 1, keys + pos, sizeof(Key) * (count - pos));
          memmove(payloads + pos + 1, payloads + pos, sizeof(Payload) * (count - pos));
          keys[pos] = k;
@@ -225,13 +248,16 @@ struct BTreeLeaf : public BTreeLeafBase {
 
    BTreeLeaf* split(Key& sep) {
       BTreeLeaf* newLeaf = new BTreeLeaf();
-      newLeaf->count = count - (count / 2);
+      newLeaf->count = rightSplitCount();
+      newLeaf->appendStreak = std::exchange(appendStreak, static_cast<uint8_t>(0));
       count = count - newLeaf->count;
       memcpy(newLeaf->keys, keys + count, sizeof(Key) * newLeaf->count);
       memcpy(newLeaf->payloads, payloads + count, sizeof(Payload) * newLeaf->count);
       sep = keys[count - 1];
       newLeaf->setFences({.isInfinity = false, .key = sep}, fenceKeys.getUpper());  // order is important
       setFences(fenceKeys.getLower(), {.isInfinity = false, .key = sep});
+      newLeaf->next = next;
+      next = newLeaf;
       return newLeaf;
    }
 
@@ -313,7 +339,8 @@ struct BTreeInner : public BTreeInnerBase {
 
    BTreeInner* split(Key& sep) {
       BTreeInner* newInner = new BTreeInner();
-      newInner->count = count - (count / 2);
+      newInner->count = rightSplitCount();
+      newInner->appendStreak = std::exchange(appendStreak, static_cast<uint8_t>(0));
       count = static_cast<uint16_t>(count - newInner->count - static_cast<uint16_t>(1));
       sep = keys[count];
       memcpy(newInner->keys, keys + count + 1, sizeof(Key) * (newInner->count + 1));
@@ -339,6 +366,7 @@ struct BTreeInner : public BTreeInnerBase {
    void insert(Key k, NodeBase* child) {
       assert(count < maxEntries - 1);
       unsigned pos = lowerBound(k);
+      trackAppend(pos == count);
       memmove(keys + pos + 1, keys + pos, sizeof(Key) * (count - pos + 1));
       memmove(children + pos + 1, children + pos, sizeof(NodeBase*) * (count - pos + 1));
       keys[pos] = k;
@@ -581,10 +609,15 @@ struct BTree {
 
          if ((inner->count >= 2) && ((pos + 1) < inner->count)) {
             BTreeLeaf<Key, Value>* right = static_cast<BTreeLeaf<Key, Value>*>(inner->children[pos + 1]);
-            // XXX todo  lock right node here
-            
+            right->writeLockOrRestart(needRestart);
+            if (needRestart) {
+               node->writeUnlock();
+               parent->writeUnlock();
+               goto restart;
+            }
             // check if right fits into current node
             if (leaf->count + right->count >= BTreeLeaf<Key,Value>::maxEntries) {
+               right->writeUnlock();
                bool success = leaf->remove(k);
                node->writeUnlock();
                parent->writeUnlock();
@@ -592,12 +625,15 @@ struct BTree {
             }
 
             leaf->setFences(leaf->fenceKeys.getLower(), right->fenceKeys.getUpper());
+            leaf->next = right->next;
             // copy right node to current node and remove from parent
             memcpy(leaf->keys + leaf->count, right->keys, sizeof(Key) * right->count);
             memcpy(leaf->payloads + leaf->count, right->payloads, sizeof(Value) * right->count);
             // adjust count
             leaf->count += right->count;
             inner->remove(pos);
+            // scans which followed the sibling link into right restart
+            right->writeUnlockObsolete();
             // currently leakes right node ptr due to optimistic latching        
          }
          bool success = leaf->remove(k);
@@ -641,6 +677,9 @@ struct BTree {
       // -------------------------------------------------------------------------------------
       // inner traversal
       auto next_node(Key k, BTreeInner<Key>& inner) { return inner.children[inner.lowerBound(k)]; }
+      // leaves only link to the right, descending scans traverse from the root for every leaf
+      BTreeLeaf<Key, Value>* sibling(BTreeLeaf<Key, Value>&) { return nullptr; }
+      bool adjacent(Key, BTreeLeaf<Key, Value>&) { return false; }
 
       // -------------------------------------------------------------------------------------
       template <class Fn>
@@ -689,6 +728,11 @@ struct BTree {
          else
             return inner.children[inner.upperBound(k)]; 
       }
+      BTreeLeaf<Key, Value>* sibling(BTreeLeaf<Key, Value>& leaf) { return leaf.next; }
+      // the sibling continues the scan if it starts right after the upper fence of the previous leaf
+      bool adjacent(Key previous_upper, BTreeLeaf<Key, Value>& leaf) {
+         return !leaf.fenceKeys.isLowerInfinity() && leaf.fenceKeys.getLower().key == previous_upper;
+      }
       // -------------------------------------------------------------------------------------
       template <class Fn>
       op_result operator()(Key k, BTreeLeaf<Key, Value>& leaf, Fn&& func) {
@@ -723,11 +767,18 @@ struct BTree {
       } while (res.return_code == RC::CONTINUE);
    }
    // -------------------------------------------------------------------------------------
+   // optimistic restarts after which a scan continues with shared latches
+   static constexpr int SHARED_SCAN_AFTER_RESTARTS = 4;
+   // walks the leaves along the sibling links and traverses from the root only after a conflict; the entries of a leaf
+   // are copied and handed to func once the leaf version validated, hence a restart never repeats them
    template <class Fn, class SCAN_DIRECTION>
    op_result scan_(Key k, Fn&& func, SCAN_DIRECTION scan_functor) {
+      using Leaf = BTreeLeaf<Key, Value>;
+      std::pair<Key, Value> staged[Leaf::maxEntries];
       int restartCount = 0;
    restart:
       if (restartCount++) yield(restartCount);
+      if (restartCount > SHARED_SCAN_AFTER_RESTARTS) return scan_shared_(k, func, scan_functor);
       bool needRestart = false;
 
       NodeBase* node = root;
@@ -754,20 +805,86 @@ struct BTree {
          versionNode = node->readLockOrRestart(needRestart);
          if (needRestart) goto restart;
       }
-      // -------------------------------------------------------------------------------------
-      BTreeLeaf<Key, Value>* leaf = static_cast<BTreeLeaf<Key, Value>*>(node);
-      auto op_code = scan_functor(k, *leaf, func);
-      // debug
-      // std::cout << "Lower fence key " << leaf->fenceKeys.getLower() << "\n";
-      // std::cout << "Upper fence key " << leaf->fenceKeys.getUpper() << "\n";
-      // -------------------------------------------------------------------------------------
       if (parent) {
          parent->readUnlockOrRestart(versionParent, needRestart);
          if (needRestart) goto restart;
       }
-      node->readUnlockOrRestart(versionNode, needRestart);
-      if (needRestart) goto restart;
-      return op_code;
+      // -------------------------------------------------------------------------------------
+      // leaf walk
+      for (;;) {
+         Leaf* leaf = static_cast<Leaf*>(node);
+         unsigned count = 0;
+         auto op_code = scan_functor(k, *leaf, [&](Key key, Value value) {
+            staged[count++] = {key, value};
+            return true;
+         });
+         Leaf* next = (op_code.return_code == RC::CONTINUE) ? scan_functor.sibling(*leaf) : nullptr;
+         node->readUnlockOrRestart(versionNode, needRestart);
+         if (needRestart) goto restart;
+         // debug
+         // std::cout << "Lower fence key " << leaf->fenceKeys.getLower() << "\n";
+         // std::cout << "Upper fence key " << leaf->fenceKeys.getUpper() << "\n";
+         for (unsigned s_i = 0; s_i < count; s_i++) {
+            if (!func(staged[s_i].first, staged[s_i].second)) return {RC::FINISHED, 0};
+         }
+         if (!next) return op_code;
+         // -------------------------------------------------------------------------------------
+         // move to the sibling; any conflict hands over to a traversal from the root at the fence
+         uint64_t versionNext = next->readLockOrRestart(needRestart);
+         if (needRestart) return op_code;
+         bool adjacent = scan_functor.adjacent(op_code.next_sep, *next);
+         next->checkOrRestart(versionNext, needRestart);
+         if (needRestart || !adjacent) return op_code;
+         k = op_code.next_sep;
+         scan_functor.isFirstTraversal = false;  // a restart continues at the fence with upper bound search
+         node = next;
+         versionNode = versionNext;
+      }
+   }
+   // -------------------------------------------------------------------------------------
+   // pessimistic variant with shared lock coupling, writers on the latched path wait for the scan to move on
+   template <class Fn, class SCAN_DIRECTION>
+   op_result scan_shared_(Key k, Fn&& func, SCAN_DIRECTION scan_functor) {
+      using Leaf = BTreeLeaf<Key, Value>;
+      NodeBase* node = root;
+      node->readLockShared();
+      while (node != root) {
+         node->readUnlockShared();
+         node = root;
+         node->readLockShared();
+      }
+      // -------------------------------------------------------------------------------------
+      // inner traversal
+      while (node->type == PageType::BTreeInner) {
+         auto inner = static_cast<BTreeInner<Key>*>(node);
+         node = scan_functor.next_node(k, *inner);  // upper or lower bound
+         node->readLockShared();
+         inner->readUnlockShared();
+      }
+      // -------------------------------------------------------------------------------------
+      // leaf walk; the leaf cannot change while it is latched, entries go to func directly
+      for (;;) {
+         Leaf* leaf = static_cast<Leaf*>(node);
+         bool stopped = false;
+         auto op_code = scan_functor(k, *leaf, [&](Key key, Value value) {
+            stopped = !func(key, value);
+            return !stopped;
+         });
+         Leaf* next = (op_code.return_code == RC::CONTINUE && !stopped) ? scan_functor.sibling(*leaf) : nullptr;
+         if (!next) {
+            leaf->readUnlockShared();
+            return stopped ? op_result{RC::FINISHED, 0} : op_code;
+         }
+         next->readLockShared();
+         leaf->readUnlockShared();
+         if (!scan_functor.adjacent(op_code.next_sep, *next)) {
+            next->readUnlockShared();
+            return op_code;
+         }
+         k = op_code.next_sep;
+         scan_functor.isFirstTraversal = false;
+         node = next;
+      }
    }
 };
 }  // namespace twosided
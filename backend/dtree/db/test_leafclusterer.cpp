@@ -0,0 +1,87 @@
+#include "Defs.hpp"
+#include "dtree/db/OneSidedBTree.hpp"
+#include "dtree/db/OneSidedLeafClusterer.hpp"
+#include "dtree/db/OneSidedStorageOps.hpp"
+// -------------------------------------------------------------------------------------
+#include <cstdint>
+#include <cstdlib>
+#include <iostream>
+// -------------------------------------------------------------------------------------
+// local test of the storage-side leaf clusterer, does not need a cluster
+
+using namespace dtree;
+using namespace dtree::onesided;
+using Leaf = ActiveLeaf<Key, Value>;
+using Inner = BTreeInner<Key>;
+using Tree = BTree<Key, Value>;
+
+static constexpr uint64_t PAGES = 64;
+static constexpr Key KEYS_PER_LEAF = 10;
+
+// the read protocol of a compute node on local pages: a latched page is waited for, a page that changed or retired
+// since it was read restarts the lookup at the parent. Returns false if it gives up on a page that stays latched
+static bool lookup(Inner* parent, RemotePtr child, uint64_t parent_version, const Key& key, Value& value) {
+   auto* leaf = local_page<Leaf>(child);
+   size_t waits = 0;
+   while (exclusively_latched(std::atomic_ref<uint64_t>(leaf->remote_latch).load()))
+      if (++waits == 1'000'000) return false;
+   if (leaf->retired || parent->version != parent_version) {
+      ensure(!exclusively_latched(parent->remote_latch));
+      return lookup(parent, parent->next_child(key), parent->version, key, value);
+   }
+   return leaf->lookup(key, value);
+}
+
+int main() {
+   auto* node_buffer = static_cast<uint8_t*>(std::aligned_alloc(BTREE_NODE_SIZE, PAGES * BTREE_NODE_SIZE));
+   for (uint64_t p_i = 0; p_i < PAGES; p_i++)
+      allocateInRDMARegion<Leaf>(reinterpret_cast<Leaf*>(node_buffer + (p_i * BTREE_NODE_SIZE)));
+   uint64_t page_counter = PAGES / 2;  // the upper half is free for the run
+   LeafClusterer<Key, Value> clusterer(0, page_counter, node_buffer);
+   //=== level 1 parent with leaves on every other page ===//
+   auto parent_ptr = clusterer.page(0);
+   auto* parent = local_page<Inner>(parent_ptr);
+   allocateInRDMARegion<Inner>(parent);
+   parent->level = 1;
+   constexpr uint64_t LEAVES = 4;
+   RemotePtr leaves[LEAVES];
+   for (uint64_t l_i = 0; l_i < LEAVES; l_i++) {
+      leaves[l_i] = clusterer.page(2 * (l_i + 1));
+      auto* leaf = local_page<Leaf>(leaves[l_i]);
+      FenceKeys<Key>::FenceKey lower{.isInfinity = l_i == 0, .key = l_i * KEYS_PER_LEAF};
+      FenceKeys<Key>::FenceKey upper{.isInfinity = l_i == LEAVES - 1, .key = (l_i + 1) * KEYS_PER_LEAF};
+      leaf->fenceKeys.setFences(lower, upper);
+      for (Key k = (l_i * KEYS_PER_LEAF) + 1; k <= (l_i + 1) * KEYS_PER_LEAF; k++) leaf->upsert(k, k * 2);
+      if (l_i > 0) {
+         local_page<Leaf>(leaves[l_i - 1])->setRightLink(leaves[l_i]);
+         parent->insert(l_i * KEYS_PER_LEAF, leaves[l_i - 1], leaves[l_i]);
+      }
+   }
+   ensure(parent->end() + 1u == LEAVES);
+   //=== a reader holds the old child pointer across the relocation ===//
+   Key key = KEYS_PER_LEAF + 3;
+   auto stale_child = parent->next_child(key);
+   auto stale_version = parent->version;
+   ensure(stale_child == leaves[1]);
+   ensure(clusterer.cluster(parent_ptr));
+   ensure(!exclusively_latched(parent->remote_latch) && parent->version != stale_version);
+   for (auto& old : leaves) {
+      auto* leaf = local_page<Leaf>(old);
+      ensure(leaf->retired && !exclusively_latched(leaf->remote_latch));
+   }
+   Value value = 0;
+   ensure(lookup(parent, stale_child, stale_version, key, value));
+   ensure(value == key * 2);
+   //=== the run is contiguous, linked and holds every key ===//
+   ensure(Tree::contiguous_run(parent, 0, LEAVES) == LEAVES);
+   for (uint64_t l_i = 0; l_i + 1 < LEAVES; l_i++)
+      ensure(local_page<Leaf>(parent->children[l_i])->getRightLink() == parent->children[l_i + 1]);
+   for (Key k = 1; k <= LEAVES * KEYS_PER_LEAF; k++) {
+      ensure(lookup(parent, parent->next_child(k), parent->version, k, value));
+      ensure(value == k * 2);
+   }
+   ensure(!clusterer.cluster(parent_ptr));  // already clustered
+   std::free(node_buffer);
+   std::cout << "Validation [OK]" << std::endl;
+   return 0;
+}
@@ -0,0 +1,112 @@
+#include "Defs.hpp"
+#include "dtree/Compute.hpp"
+#include "dtree/Config.hpp"
+#include "dtree/Storage.hpp"
+#include "dtree/db/OneSidedBlobTree.hpp"
+#include "dtree/threads/Concurrency.hpp"
+#include "dtree/threads/Worker.hpp"
+#include "dtree/utils/RandomGenerator.hpp"
+// -------------------------------------------------------------------------------------
+#include <gflags/gflags.h>
+#include <unistd.h>
+// -------------------------------------------------------------------------------------
+#include <algorithm>
+#include <array>
+#include <cstdint>
+#include <iostream>
+#include <span>
+#include <vector>
+// -------------------------------------------------------------------------------------
+// validation of the one-sided tree with out-of-line values; storage nodes need --blob_heap_percentage
+
+DEFINE_uint64(blob_keys, 100000, "keys [1, blob_keys] inserted by the compute node");
+
+// length and content depend on the key, a payload of another key or a torn one is detected
+static std::vector<uint8_t> make_payload(Key key) {
+   std::vector<uint8_t> payload(8 + (key % 512));
+   for (size_t b_i = 0; b_i < payload.size(); b_i++) payload[b_i] = static_cast<uint8_t>(key + b_i);
+   return payload;
+}
+static bool matches(Key key, std::span<uint8_t> value) {
+   auto expected = make_payload(key);
+   return value.size() == expected.size() && std::equal(value.begin(), value.end(), expected.begin());
+}
+
+//=== Storage Logic ===//
+void storage_node() {
+   using namespace dtree;
+   Storage store;
+   store.startMessageHandler();
+   while (store.getConnectedClients() == 0)
+      ;
+   while (true) sleep(1);
+}
+
+//=== Main ===//
+int main(int argc, char* argv[]) {
+   using namespace dtree;
+   gflags::SetUsageMessage("Dtree blob tree validation");
+   gflags::ParseCommandLineFlags(&argc, &argv, true);
+   auto partition = [&](uint64_t id, uint64_t participants, uint64_t N) -> std::pair<size_t, size_t> {
+      const uint64_t blockSize = N / participants;
+      auto begin = id * blockSize;
+      auto end = begin + blockSize;
+      if (id == participants - 1) end = N;
+      return {begin, end};
+   };
+   if (FLAGS_storage_node) {
+      std::cout << "started storage node" << std::endl;
+      storage_node();
+      return 0;
+   }
+   std::cout << "started compute node" << std::endl;
+   Compute<threads::onesided::Worker> comp;
+   comp.startAndConnect();
+   //=== build tree ===//
+   // every worker inserts a contiguous key range, hence the payloads of consecutive keys mostly share a blob chunk
+   // and thereby a storage node
+   for (uint64_t t_i = 0; t_i < FLAGS_worker; ++t_i) {
+      comp.getWorkerPool().scheduleJobAsync(t_i, [&, t_i]() {
+         onesided::BlobBTree<Key> tree(threads::onesided::Worker::my().metadataPage);
+         auto p = partition(t_i, FLAGS_worker, FLAGS_blob_keys);
+         for (Key k = p.first + 1; k <= p.second; k++) {
+            auto payload = make_payload(k);
+            tree.insert(k, payload.data(), payload.size());
+         }
+      });
+   }
+   comp.getWorkerPool().joinAll();
+   //=== point and multi-get lookups ===//
+   for (uint64_t t_i = 0; t_i < FLAGS_worker; ++t_i) {
+      comp.getWorkerPool().scheduleJobAsync(t_i, [&]() {
+         onesided::BlobBTree<Key> tree(threads::onesided::Worker::my().metadataPage);
+         for (size_t l_i = 0; l_i < 1000; l_i++) {
+            Key key = utils::RandomGenerator::getRandU64(1, FLAGS_blob_keys + 1);
+            std::span<uint8_t> value;
+            ensure(tree.lookup(key, value));
+            ensure(matches(key, value));
+         }
+         // full batches of MAX_BLOB_BATCH keys exceed the send CQ of the connection they are read over
+         std::array<Key, MAX_BLOB_BATCH> keys;
+         std::array<std::span<uint8_t>, MAX_BLOB_BATCH> values;
+         for (size_t b_i = 0; b_i < 1000; b_i++) {
+            Key first = utils::RandomGenerator::getRandU64(1, FLAGS_blob_keys + 1);
+            for (size_t k_i = 0; k_i < keys.size(); k_i++) keys[k_i] = first + k_i;
+            auto found = tree.multi_lookup(keys, values);
+            size_t expected = 0;
+            for (size_t k_i = 0; k_i < keys.size(); k_i++) {
+               if (keys[k_i] > FLAGS_blob_keys) {
+                  ensure(values[k_i].empty());
+                  continue;
+               }
+               ensure(matches(keys[k_i], values[k_i]));
+               expected++;
+            }
+            ensure(found == expected);
+         }
+      });
+   }
+   comp.getWorkerPool().joinAll();
+   std::cout << "Validation [OK]" << std::endl;
+   return 0;
+}
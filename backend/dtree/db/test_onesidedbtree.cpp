@@ -127,11 +127,8 @@ int main(int argc, char* argv[]) {
                } else {
                   std::vector<Key> result_set;
                   result_set.reserve(range);
-                  tree.range_scan(
-                      k_i, k_i + range, [&](Key& key, [[maybe_unused]] Value value) { result_set.push_back(key); },
-                      [&]() {
-                         result_set.clear();
-                      });
+                  tree.range_scan(k_i, k_i + range,
+                                  [&](Key& key, [[maybe_unused]] Value value) { result_set.push_back(key); });
                   range_scans_completed++;
                   std::for_each (std::begin(result_set), std::end(result_set), [&](Key& key) {
                      ensure(key == k_i);
@@ -156,20 +153,142 @@ int main(int argc, char* argv[]) {
          // ensure(tree.lookup(k, retValue));
          // ensure(k == retValue);
          //}
+         // injected restarts must resume after the last delivered key without gaps or duplicates
          Key current_key = 1;
-         tree.range_scan(
-             1, KEYS,
-             [&](Key& key, [[maybe_unused]] Value value) {
-                ensure(current_key == key);
-                current_key++;
-                auto rnd_fault = utils::RandomGenerator::getRandU64(0, 500000);
-                if (rnd_fault <= 1) { throw onesided::OLCRestartException(); }
-             },
-             [&]() {
-                current_key = 1;
-                std::cout << "undo function " << std::endl;
-             });
+         uint64_t injected_restarts = 0;
+         tree.range_scan(1, KEYS, [&](Key& key, [[maybe_unused]] Value value) {
+            ensure(current_key == key);
+            current_key++;
+            auto rnd_fault = utils::RandomGenerator::getRandU64(0, 500000);
+            if (rnd_fault <= 1) {
+               injected_restarts++;
+               throw onesided::OLCRestartException();
+            }
+         });
+         ensure(current_key == KEYS + 1);
+         std::cout << "injected restarts " << injected_restarts << std::endl;
+         // paginated scan with continuation tokens
+         current_key = 1;
+         onesided::ScanToken<Key> token;
+         for (bool first_page = true; first_page || !token.exhausted; first_page = false) {
+            using Tree = onesided::BTree<Key, Value>;
+            auto cursor = first_page ? onesided::Cursor<Tree>(tree, 1, KEYS, 1000)
+                                     : onesided::Cursor<Tree>(tree, token, KEYS, 1000);
+            Key key;
+            Value value;
+            while (cursor.next(key, value)) ensure(current_key++ == key);
+            token = cursor.token();
+         }
+         ensure(current_key == KEYS + 1);
+         // descending scan
+         current_key = KEYS;
+         tree.range_scan_desc(KEYS, 1, [&](Key& key, [[maybe_unused]] Value value) { ensure(current_key-- == key); });
+         ensure(current_key == 0);
       });
+      //=== conditional writes ===//
+      // with and without --in_place_updates: concurrent increments by update and compare_and_swap must not get lost,
+      // concurrent insert_if_absent of the same keys must succeed exactly once per key
+      constexpr Key COUNTERS = 64;
+      constexpr size_t INCREMENTS = 10000;  // per worker
+      constexpr Key ABSENT_KEYS = 1000;
+      auto counter_sum = [&]() {
+         Value sum = 0;
+         comp.getWorkerPool().scheduleJobSync(0, [&]() {
+            onesided::BTree<Key, Value> tree(threads::onesided::Worker::my().metadataPage);
+            for (Key k = 1; k <= COUNTERS; k++) {
+               Value value;
+               ensure(tree.lookup(k, value));
+               sum += value;
+            }
+         });
+         return sum;
+      };
+      auto in_place_updates = FLAGS_in_place_updates;
+      Key absent_begin = KEYS + 1;
+      for (bool in_place : {false, true}) {
+         FLAGS_in_place_updates = in_place;
+         auto before = counter_sum();
+         std::atomic<u64> first_inserts = 0;
+         for (uint64_t t_i = 0; t_i < FLAGS_worker; ++t_i) {
+            comp.getWorkerPool().scheduleJobAsync(t_i, [&, t_i]() {
+               onesided::BTree<Key, Value> tree(threads::onesided::Worker::my().metadataPage);
+               for (size_t i_i = 0; i_i < INCREMENTS; i_i++) {
+                  Key k = utils::RandomGenerator::getRandU64(1, COUNTERS + 1);
+                  if (i_i % 2 == 0) {
+                     ensure(tree.update(k, [](Value& value) { value++; }));
+                     continue;
+                  }
+                  Value value;
+                  ensure(tree.lookup(k, value));
+                  while (!tree.compare_and_swap(k, value, value + 1)) ensure(tree.lookup(k, value));
+               }
+               for (Key k = absent_begin; k < absent_begin + ABSENT_KEYS; k++)
+                  if (tree.insert_if_absent(k, t_i)) first_inserts++;
+            });
+         }
+         comp.getWorkerPool().joinAll();
+         ensure(counter_sum() == before + (FLAGS_worker * INCREMENTS));
+         ensure(first_inserts == ABSENT_KEYS);
+         comp.getWorkerPool().scheduleJobSync(0, [&]() {
+            onesided::BTree<Key, Value> tree(threads::onesided::Worker::my().metadataPage);
+            for (Key k = absent_begin; k < absent_begin + ABSENT_KEYS; k++) {
+               Value value;
+               ensure(tree.lookup(k, value));
+               ensure(value < FLAGS_worker);
+            }
+         });
+         absent_begin += ABSENT_KEYS;
+         // an update of a leaf that another worker holds exclusively has to wait for the latch; a CAS applied in
+         // place meanwhile would be overwritten by the write-back of the latched copy
+         if (FLAGS_worker < 2) continue;
+         auto before_latched = counter_sum();
+         std::atomic<bool> latched = false;
+         std::atomic<bool> updating = false;
+         comp.getWorkerPool().scheduleJobAsync(0, [&]() {
+            onesided::BTree<Key, Value> tree(threads::onesided::Worker::my().metadataPage);
+            onesided::GuardX<onesided::NodePlaceholder> x_leaf(tree.locate_leaf(1));
+            latched = true;
+            while (!updating) _mm_pause();
+            usleep(10000);
+            x_leaf.release();
+         });
+         comp.getWorkerPool().scheduleJobAsync(1, [&]() {
+            onesided::BTree<Key, Value> tree(threads::onesided::Worker::my().metadataPage);
+            while (!latched) _mm_pause();
+            updating = true;
+            ensure(tree.update(1, [](Value& value) { value++; }));
+         });
+         comp.getWorkerPool().joinAll();
+         ensure(counter_sum() == before_latched + 1);
+      }
+      FLAGS_in_place_updates = in_place_updates;
+      //=== shared reads ===//
+      // lookups and scans under shared leaf latches next to writers that latch the same leaves exclusively
+      using SharedTree = onesided::BTree<Key, Value, onesided::ActiveLeaf<Key, Value>, onesided::SharedReads>;
+      for (uint64_t t_i = 0; t_i < FLAGS_worker; ++t_i) {
+         comp.getWorkerPool().scheduleJobAsync(t_i, [&, t_i]() {
+            SharedTree tree(threads::onesided::Worker::my().metadataPage);
+            for (size_t o_i = 0; o_i < 10000; o_i++) {
+               Key k = utils::RandomGenerator::getRandU64(COUNTERS + 1, KEYS + 1);
+               if (t_i % 2 == 0 && o_i % 2 == 0) {
+                  tree.insert(k, k);
+               } else if (o_i % 8 == 1) {
+                  auto range = std::min<Key>(utils::RandomGenerator::getRandU64(10, 10000), KEYS - k);
+                  Key next = k;
+                  tree.range_scan(k, k + range, [&](Key& key, Value value) {
+                     ensure(key == next++);
+                     ensure(value == key);
+                  });
+                  ensure(next == k + range + 1);
+               } else {
+                  Value value;
+                  ensure(tree.lookup(k, value));
+                  ensure(value == k);
+               }
+            }
+         });
+      }
+      comp.getWorkerPool().joinAll();
       std::cout << "Validation [OK]" << std::endl;
       std::cout << "range scans completed " << range_scans_completed << std::endl;
    }
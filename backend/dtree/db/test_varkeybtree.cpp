@@ -0,0 +1,122 @@
+#include "Defs.hpp"
+#include "dtree/db/VarKeyBTree.hpp"
+// -------------------------------------------------------------------------------------
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <iostream>
+#include <map>
+#include <random>
+#include <string>
+#include <thread>
+#include <vector>
+// -------------------------------------------------------------------------------------
+// local test of the variable-length key tree, does not need a cluster
+
+static std::string make_key(std::mt19937_64& rng) {
+   static const std::vector<std::string> prefixes{"user:", "user:profile:", "order:2023-", "order:2024-", ""};
+   std::string key = prefixes[rng() % prefixes.size()];
+   auto length = 16 + rng() % (MAX_VAR_KEY_LENGTH - 16 - key.size());
+   while (key.size() < length) key.push_back(static_cast<char>('a' + rng() % 26));
+   return key;
+}
+
+int main() {
+   using namespace twosided;
+   VarKeyBTree<uint64_t> tree;
+   std::map<std::string, uint64_t> reference;
+   std::mt19937_64 rng(42);
+   //=== insert and update ===//
+   for (uint64_t i = 0; i < 200000; i++) {
+      auto key = make_key(rng);
+      tree.insert(key, i);
+      reference[key] = i;
+   }
+   for (auto& [key, value] : reference) {
+      uint64_t result = 0;
+      ensure(tree.lookup(key, result));
+      ensure(result == value);
+   }
+   uint64_t result = 0;
+   ensure(!tree.lookup("user:", result));
+   ensure(!tree.lookup(std::string(MAX_VAR_KEY_LENGTH, 'z'), result));
+   //=== scan ===//
+   {
+      auto it = reference.lower_bound("order:2024-");
+      uint64_t scanned = 0;
+      tree.scan("order:2024-", [&](std::string_view key, uint64_t value) {
+         ensure(it != reference.end());
+         ensure(key == it->first && value == it->second);
+         ++it;
+         return ++scanned < 10000;
+      });
+      ensure(scanned == std::min<uint64_t>(10000, std::distance(reference.lower_bound("order:2024-"), reference.end())));
+   }
+   //=== remove ===//
+   uint64_t removed = 0;
+   for (auto it = reference.begin(); it != reference.end();) {
+      if ((removed++ % 3) == 0) {
+         ensure(tree.remove(it->first));
+         it = reference.erase(it);
+      } else {
+         ++it;
+      }
+   }
+   uint64_t scanned = 0;
+   auto it = reference.begin();
+   tree.scan("", [&](std::string_view key, uint64_t value) {
+      ensure(key == it->first && value == it->second);
+      ++it;
+      scanned++;
+      return true;
+   });
+   ensure(scanned == reference.size());
+   //=== concurrent inserts ===//
+   VarKeyBTree<uint64_t> concurrent;
+   std::vector<std::thread> threads;
+   for (uint64_t t_i = 0; t_i < 4; t_i++) {
+      threads.emplace_back([&, t_i]() {
+         for (uint64_t i = t_i; i < 100000; i += 4) concurrent.insert("key:" + std::to_string(i), i);
+      });
+   }
+   for (auto& t : threads) t.join();
+   for (uint64_t i = 0; i < 100000; i++) {
+      ensure(concurrent.lookup("key:" + std::to_string(i), result));
+      ensure(result == i);
+   }
+   //=== concurrent inserts and scans ===//
+   // scans see every preloaded key exactly once, in order and with its own value, while inserts split the leaves
+   VarKeyBTree<uint64_t> scanned_tree;
+   constexpr uint64_t scan_keys = 100000;
+   auto scan_key = [](uint64_t i) { return "scan:" + std::to_string(i); };
+   for (uint64_t i = 0; i < scan_keys; i += 2) scanned_tree.insert(scan_key(i), i);
+   std::atomic<bool> inserting{true};
+   std::vector<std::thread> writers;
+   for (uint64_t t_i = 0; t_i < 2; t_i++) {
+      writers.emplace_back([&, t_i]() {
+         for (uint64_t i = 1 + 2 * t_i; i < scan_keys; i += 4) scanned_tree.insert(scan_key(i), i);
+      });
+   }
+   std::vector<std::thread> scanners;
+   for (uint64_t t_i = 0; t_i < 2; t_i++) {
+      scanners.emplace_back([&]() {
+         do {
+            std::string previous;
+            uint64_t preloaded = 0;
+            scanned_tree.scan("scan:", [&](std::string_view key, uint64_t value) {
+               ensure(previous.empty() || key > previous);
+               ensure(key == scan_key(value));
+               if ((value % 2) == 0) preloaded++;
+               previous = key;
+               return true;
+            });
+            ensure(preloaded == scan_keys / 2);
+         } while (inserting);
+      });
+   }
+   for (auto& t : writers) t.join();
+   inserting = false;
+   for (auto& t : scanners) t.join();
+   std::cout << "var key btree test passed" << std::endl;
+   return 0;
+}
@@ -18,6 +18,10 @@ struct WorkerCounters {
       tx_p,
       latency,
       mh_msgs_handled,
+      leaf_reads,
+      leaf_read_bytes,
+      leaf_cache_hits,
+      leaf_cache_misses,
       COUNT,
    };
    // -------------------------------------------------------------------------------------
@@ -25,6 +29,10 @@ struct WorkerCounters {
        "tx/sec",
        "latency",
        "msgs. handled",
+       "leaf READs",
+       "leaf bytes",
+       "cache hits",
+       "cache misses",
    };
    static_assert(workerCounterTranslation.size() == COUNT);
    // -------------------------------------------------------------------------------------
@@ -37,6 +45,10 @@ struct WorkerCounters {
        {"tx/sec", LOG_LEVEL::RELEASE},
        {"latency", LOG_LEVEL::RELEASE},
        {"msgs. handled", LOG_LEVEL::RELEASE},
+       {"leaf READs", LOG_LEVEL::RELEASE},
+       {"leaf bytes", LOG_LEVEL::RELEASE},
+       {"cache hits", LOG_LEVEL::RELEASE},
+       {"cache misses", LOG_LEVEL::RELEASE},
    }};
    // -------------------------------------------------------------------------------------
    
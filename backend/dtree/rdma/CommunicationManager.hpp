@@ -15,6 +15,7 @@
 #include <sys/types.h>
 #include <unistd.h>
 
+#include <array>
 #include <atomic>
 #include <cassert>
 #include <cstdint>
@@ -107,6 +108,62 @@ void postWriteBatch(RdmaContext& context, completion wc, ARGS&&... args) {
 }
 
 // -------------------------------------------------------------------------------------
+// -------------------------------------------------------------------------------------
+// Runtime batching
+// -------------------------------------------------------------------------------------
+// work requests to one connection linked through next and posted with one ibv_post_send, only the last one may be
+// signaled. Completions of a connection arrive in order, hence its completion implies all others
+template <size_t CAPACITY>
+struct WorkRequestChain {
+   std::array<ibv_send_wr, CAPACITY> sq_wr;
+   std::array<ibv_sge, CAPACITY> send_sgl;
+   size_t size{0};
+
+   bool empty() const { return size == 0; }
+   void read(void* memAddr, size_t bytes, size_t remoteOffset, size_t wcId = 0) {
+      auto& wr = add(memAddr, bytes, IBV_WR_RDMA_READ);
+      wr.wr.rdma.remote_addr = remoteOffset;
+      wr.wr_id = wcId;
+   }
+   void fetchAdd(uint64_t to_add, uint64_t* memAddr, size_t remoteOffset) {
+      auto& wr = add(memAddr, sizeof(uint64_t), IBV_WR_ATOMIC_FETCH_AND_ADD);
+      wr.wr.atomic.remote_addr = remoteOffset;
+      wr.wr.atomic.compare_add = to_add;
+   }
+   // posts and empties the chain
+   void post(RdmaContext& context, completion wc) {
+      if (size == 0) return;
+      for (size_t w_i = 0; w_i < size; w_i++) {
+         send_sgl[w_i].lkey = context.mr->lkey;
+         if (sq_wr[w_i].opcode == IBV_WR_RDMA_READ)
+            sq_wr[w_i].wr.rdma.rkey = context.rkey;
+         else
+            sq_wr[w_i].wr.atomic.rkey = context.rkey;
+         sq_wr[w_i].send_flags = ((w_i == size - 1) && wc) ? IBV_SEND_SIGNALED : 0;
+         sq_wr[w_i].next = (w_i == size - 1) ? nullptr : &sq_wr[w_i + 1];
+      }
+      size = 0;
+      struct ibv_send_wr* bad_wr;
+      auto ret = ibv_post_send(context.id->qp, &sq_wr[0], &bad_wr);
+      if (ret)
+         throw std::runtime_error("Failed to post send request" + std::to_string(ret) + " " + std::to_string(errno));
+   }
+
+  private:
+   ibv_send_wr& add(void* memAddr, size_t bytes, ibv_wr_opcode opcode) {
+      if (size == CAPACITY) throw std::runtime_error("work request chain is full");
+      auto& sge = send_sgl[size];
+      sge.addr = (uintptr_t)memAddr;
+      sge.length = static_cast<uint32_t>(bytes);
+      auto& wr = sq_wr[size++];
+      wr = {};
+      wr.opcode = opcode;
+      wr.sg_list = &sge;
+      wr.num_sge = 1;
+      return wr;
+   }
+};
+
 
 inline void postReceive(void* memAddr, size_t size, ibv_qp* qp, ibv_mr* mr) {
    struct ibv_recv_wr rq_wr; /* recv work request record */
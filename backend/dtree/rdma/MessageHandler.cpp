@@ -99,8 +99,12 @@ void MessageHandler::init() {
       initServer->barrierAddr = (uintptr_t)db.barrier;
       initServer->remote_cache_counter = (uintptr_t)db.cache_counter;
       initServer->remote_cache_offset = (uintptr_t)db.node_buffer;
+      initServer->remote_blob_counter = (uintptr_t)db.blob_counter;
+      initServer->remote_blob_offset = (uintptr_t)db.blob_heap;
+      initServer->remote_blob_size = db.blob_heap_size;
       initServer->nodeId = nodeId;
       initServer->metadataOffset = (uintptr_t)db.md;
+      initServer->split_hint_ring = (uintptr_t)db.split_hints;
       initServer->threadId = 1000;
       // -------------------------------------------------------------------------------------
       cm.exchangeInitialMesssage(*(cctx.rctx), initServer);
@@ -147,6 +151,7 @@ void MessageHandler::startThread() {
          }
          
          auto& tree = db.getTree();
+         auto& var_tree = db.getVarTree();
          MailboxPartition& mbPartition = mbPartitions[t_i];
          uint8_t* mailboxes = mbPartition.mailboxes;
          const uint64_t beginId = mbPartition.beginId;
@@ -198,11 +203,16 @@ void MessageHandler::startThread() {
                      auto& response = *MessageFabric::createMessage<rdma::ScanResponse>(ctx.response);
                      response.rc = rdma::RESULT::ABORTED;
                      uint64_t length {0};
+                     auto limit = std::min<uint64_t>(request.limit, MAX_SCAN_RESULT);
+                     response.has_more = false;
 
                      tree.scan<twosided::BTree<Key,Value>::ASC_SCAN>(request.from, [&](Key key, Value value){
                         // copy value to buffer
                         if(key <= request.to){
-                           ensure(length < MAX_SCAN_RESULT);
+                           if (length == limit) {
+                              response.has_more = true;
+                              return false;
+                           }
                            ctx.scan_buffer[length].key = key;
                            ctx.scan_buffer[length++].value = value;
                            return true;
@@ -215,6 +225,83 @@ void MessageHandler::startThread() {
                      writeMsg(clientId, response);
                      break;
                   }                     
+                  case MESSAGE_TYPE::LeafInsert:{
+                     auto& request = *reinterpret_cast<rdma::LeafInsertRequest*>(ctx.request);
+                     auto& response = *MessageFabric::createMessage<rdma::InsertResponse>(ctx.response);
+                     response.rc = rdma::RESULT::ABORTED;
+                     if (onesided::local_upsert<onesided::ActiveLeaf<Key, Value>>(nodeId, RemotePtr(request.leaf),
+                                                                                 request.key, request.value))
+                        response.rc = rdma::RESULT::COMMITTED;
+                     writeMsg(clientId, response);
+                     break;
+                  }
+                  case MESSAGE_TYPE::Traverse:{
+                     auto& request = *reinterpret_cast<rdma::TraverseRequest*>(ctx.request);
+                     auto& response = *MessageFabric::createMessage<rdma::TraverseResponse>(ctx.response);
+                     auto descent = onesided::local_descend(nodeId, RemotePtr(request.start), request.from_metadata,
+                                                            request.key);
+                     response.rc = descent.valid ? rdma::RESULT::COMMITTED : rdma::RESULT::ABORTED;
+                     response.node = descent.node.offset;
+                     response.leaf = descent.leaf;
+                     writeMsg(clientId, response);
+                     break;
+                  }
+                  case MESSAGE_TYPE::TreeScan:{
+                     auto& request = *reinterpret_cast<rdma::TreeScanRequest*>(ctx.request);
+                     auto& response = *MessageFabric::createMessage<rdma::TreeScanResponse>(ctx.response);
+                     auto limit = std::clamp<uint64_t>(request.limit, 1, MAX_SCAN_RESULT);
+                     auto scan = onesided::local_scan<onesided::ActiveLeaf<Key, Value>>(
+                         nodeId, RemotePtr(request.start), request.from_metadata, request.from, request.to, limit,
+                         ctx.scan_buffer);
+                     response.rc = scan.valid ? rdma::RESULT::COMMITTED : rdma::RESULT::ABORTED;
+                     response.length = scan.length;
+                     response.has_more = scan.has_more;
+                     response.next = scan.next.offset;
+                     response.resume = scan.resume;
+                     if (scan.length > 0)
+                        rdma::postWrite(ctx.scan_buffer, *(cctxs[clientId].rctx), rdma::completion::unsignaled,
+                                        cctxs[clientId].result_buffer, sizeof(KVPair) * scan.length);
+                     writeMsg(clientId, response);
+                     break;
+                  }
+                  case MESSAGE_TYPE::VarInsert:{
+                     auto& request = *reinterpret_cast<rdma::VarInsertRequest*>(ctx.request);
+                     auto& response = *MessageFabric::createMessage<rdma::InsertResponse>(ctx.response);
+                     var_tree.insert(request.getKey(), request.value);
+                     response.rc = rdma::RESULT::COMMITTED;
+                     writeMsg(clientId, response);
+                     break;
+                  }
+                  case MESSAGE_TYPE::VarLookup:{
+                     auto& request = *reinterpret_cast<rdma::VarLookupRequest*>(ctx.request);
+                     auto& response = *MessageFabric::createMessage<rdma::LookupResponse>(ctx.response);
+                     response.rc = rdma::RESULT::ABORTED;
+                     Value result = 0;
+                     if(var_tree.lookup(request.getKey(), result))
+                        response.rc = rdma::RESULT::COMMITTED;
+                     response.value = result;
+                     writeMsg(clientId, response);
+                     break;
+                  }
+                  case MESSAGE_TYPE::VarScan:{
+                     auto& request = *reinterpret_cast<rdma::VarScanRequest*>(ctx.request);
+                     auto& response = *MessageFabric::createMessage<rdma::ScanResponse>(ctx.response);
+                     auto* buffer = reinterpret_cast<uint8_t*>(ctx.scan_buffer);
+                     uint64_t length {0};
+                     var_tree.scan(request.getFrom(), [&](std::string_view key, Value value){
+                        if(key <= request.getTo()){
+                           ensure(length + VarScanEncoding::bytes(key.size()) <= sizeof(KVPair) * MAX_SCAN_RESULT);
+                           length += VarScanEncoding::encode(buffer + length, key, value);
+                           return true;
+                        }
+                        return false;
+                     });
+                     response.rc = rdma::RESULT::COMMITTED;
+                     response.length = length;
+                     rdma::postWrite(buffer, *(cctxs[clientId].rctx), rdma::completion::unsignaled, cctxs[clientId].result_buffer, length);
+                     writeMsg(clientId, response);
+                     break;
+                  }
                   default:
                      throw std::runtime_error("Unexpected Message in MB " + std::to_string(mailboxIdx) + " type " +
                                               std::to_string((size_t)ctx.request->type));
@@ -2,6 +2,10 @@
 // -------------------------------------------------------------------------------------
 #include "Defs.hpp"
 // -------------------------------------------------------------------------------------
+#include <cstring>
+#include <span>
+#include <string_view>
+// -------------------------------------------------------------------------------------
 namespace dtree {
 namespace rdma {
 // -------------------------------------------------------------------------------------
@@ -11,6 +15,12 @@ enum class MESSAGE_TYPE : uint8_t {
    Insert = 2,
    Lookup = 3,
    Scan = 4,
+   VarInsert = 5,
+   VarLookup = 6,
+   VarScan = 7,
+   LeafInsert = 8,
+   Traverse = 9,
+   TreeScan = 10,
    // -------------------------------------------------------------------------------------
    // -------------------------------------------------------------------------------------
    Init = 99,
@@ -37,8 +47,12 @@ struct InitMessage {
    uintptr_t barrierAddr;
    uintptr_t remote_cache_counter;
    uintptr_t remote_cache_offset;
+   uintptr_t remote_blob_counter; // bytes handed out of the blob heap
+   uintptr_t remote_blob_offset;
+   uint64_t remote_blob_size;
    uintptr_t scanResultOffset; // offset to receive scan result 
    uintptr_t metadataOffset; // only node 0 sends this
+   uintptr_t split_hint_ring;
    NodeID nodeId;  // node id of buffermanager the initiator belongs to
    uint64_t threadId;
    uint64_t num_tables;
@@ -91,6 +105,7 @@ struct ScanRequest : public Message{
    // hack hard coded as we only sent ycsb tuples or smaller
    Key from;
    Key to;
+   uint64_t limit = MAX_SCAN_RESULT;  // server stops after this many rows
    NodeID nodeId;
 };
 
@@ -98,10 +113,147 @@ struct ScanRequest : public Message{
 struct ScanResponse : public Message{
    ScanResponse() : Message(MESSAGE_TYPE::Scan){}
    size_t length;
+   bool has_more = false;  // limit was hit before the end of the range
+   RESULT rc;
+   uint8_t receiveFlag = 1;
+};
+
+// -------------------------------------------------------------------------------------
+// upsert into a leaf of the one-sided tree found by the compute node, answered with an InsertResponse;
+// ABORTED asks the compute node to insert one-sided
+struct LeafInsertRequest : public Message{
+   LeafInsertRequest() : Message(MESSAGE_TYPE::LeafInsert){}
+   uint64_t leaf;  // RemotePtr
+   Key key;
+   Value value;
+   NodeID nodeId;
+};
+
+// -------------------------------------------------------------------------------------
+// descent through the one-sided tree on the storage node owning start, as far as its nodes reach
+struct TraverseRequest : public Message{
+   TraverseRequest() : Message(MESSAGE_TYPE::Traverse){}
+   uint64_t start;  // RemotePtr of a node or, if from_metadata, of the metadata page
+   bool from_metadata;
+   Key key;
+   NodeID nodeId;
+};
+
+// node is the leaf covering key or the next node on the path, owned by another storage node;
+// ABORTED asks the compute node to start over at the metadata page
+struct TraverseResponse : public Message{
+   TraverseResponse() : Message(MESSAGE_TYPE::Traverse){}
+   uint64_t node;  // RemotePtr
+   bool leaf;
+   RESULT rc;
+   uint8_t receiveFlag = 1;
+};
+
+// scan of the one-sided tree executed by the storage node owning start (descends first, see TraverseRequest);
+// the rows are transferred one sided like those of a ScanRequest
+struct TreeScanRequest : public Message{
+   TreeScanRequest() : Message(MESSAGE_TYPE::TreeScan){}
+   uint64_t start;  // RemotePtr
+   bool from_metadata;
+   Key from;
+   Key to;
+   uint64_t limit = MAX_SCAN_RESULT;
+   NodeID nodeId;
+};
+
+// has_more: the scan continues from resume at next, which may be owned by another storage node;
+// ABORTED asks the compute node to start over at the metadata page
+struct TreeScanResponse : public Message{
+   TreeScanResponse() : Message(MESSAGE_TYPE::TreeScan){}
+   size_t length;
+   uint64_t next;  // RemotePtr
+   Key resume;
+   bool has_more = false;
    RESULT rc;
    uint8_t receiveFlag = 1;
 };
 
+// -------------------------------------------------------------------------------------
+// Variable-length key messages; only bytes() are transferred, i.e., the used part of the key buffer
+// -------------------------------------------------------------------------------------
+template <typename MSG>
+size_t var_message_bytes(const MSG& msg, const uint8_t* keys, size_t keyBytes) {
+   return static_cast<size_t>(keys - reinterpret_cast<const uint8_t*>(&msg)) + keyBytes;
+}
+
+struct VarInsertRequest : public Message{
+   VarInsertRequest() : Message(MESSAGE_TYPE::VarInsert){}
+   NodeID nodeId;
+   Value value;
+   uint16_t keyLength;
+   uint8_t key[MAX_VAR_KEY_LENGTH];
+   void setKey(std::string_view k) {
+      ensure(k.size() <= MAX_VAR_KEY_LENGTH);
+      keyLength = static_cast<uint16_t>(k.size());
+      std::memcpy(key, k.data(), k.size());
+   }
+   std::string_view getKey() const { return {reinterpret_cast<const char*>(key), keyLength}; }
+   size_t bytes() const { return var_message_bytes(*this, key, keyLength); }
+};
+
+struct VarLookupRequest : public Message{
+   VarLookupRequest() : Message(MESSAGE_TYPE::VarLookup){}
+   NodeID nodeId;
+   uint16_t keyLength;
+   uint8_t key[MAX_VAR_KEY_LENGTH];
+   void setKey(std::string_view k) {
+      ensure(k.size() <= MAX_VAR_KEY_LENGTH);
+      keyLength = static_cast<uint16_t>(k.size());
+      std::memcpy(key, k.data(), k.size());
+   }
+   std::string_view getKey() const { return {reinterpret_cast<const char*>(key), keyLength}; }
+   size_t bytes() const { return var_message_bytes(*this, key, keyLength); }
+};
+
+// from and to are stored back to back in keys
+struct VarScanRequest : public Message{
+   VarScanRequest() : Message(MESSAGE_TYPE::VarScan){}
+   NodeID nodeId;
+   uint16_t fromLength;
+   uint16_t toLength;
+   uint8_t keys[2 * MAX_VAR_KEY_LENGTH];
+   void setKeys(std::string_view from, std::string_view to) {
+      ensure(from.size() <= MAX_VAR_KEY_LENGTH && to.size() <= MAX_VAR_KEY_LENGTH);
+      fromLength = static_cast<uint16_t>(from.size());
+      toLength = static_cast<uint16_t>(to.size());
+      std::memcpy(keys, from.data(), from.size());
+      std::memcpy(keys + fromLength, to.data(), to.size());
+   }
+   std::string_view getFrom() const { return {reinterpret_cast<const char*>(keys), fromLength}; }
+   std::string_view getTo() const { return {reinterpret_cast<const char*>(keys) + fromLength, toLength}; }
+   size_t bytes() const { return var_message_bytes(*this, keys, fromLength + toLength); }
+};
+
+// var scan results are transferred one sided as a byte stream of [uint16_t key length][key][Value];
+// the ScanResponse length is the number of bytes
+struct VarScanEncoding {
+   static constexpr size_t bytes(size_t keyLength) { return sizeof(uint16_t) + keyLength + sizeof(Value); }
+   static size_t encode(uint8_t* out, std::string_view key, Value value) {
+      auto keyLength = static_cast<uint16_t>(key.size());
+      std::memcpy(out, &keyLength, sizeof(uint16_t));
+      std::memcpy(out + sizeof(uint16_t), key.data(), keyLength);
+      std::memcpy(out + sizeof(uint16_t) + keyLength, &value, sizeof(Value));
+      return bytes(keyLength);
+   }
+   template <typename FN>
+   static void decode(std::span<uint8_t> in, FN&& fn) {
+      size_t offset = 0;
+      while (offset < in.size()) {
+         uint16_t keyLength;
+         Value value;
+         std::memcpy(&keyLength, in.data() + offset, sizeof(uint16_t));
+         std::memcpy(&value, in.data() + offset + sizeof(uint16_t) + keyLength, sizeof(Value));
+         fn(std::string_view(reinterpret_cast<const char*>(in.data() + offset + sizeof(uint16_t)), keyLength), value);
+         offset += bytes(keyLength);
+      }
+   }
+};
+
 // -------------------------------------------------------------------------------------
 // Get size of Largest Message
 union ALLDERIVED {
@@ -112,6 +264,14 @@ union ALLDERIVED {
    LookupResponse lrr;
    ScanRequest scr;
    ScanResponse scrr;
+   VarInsertRequest vir;
+   VarLookupRequest vlr;
+   VarScanRequest vscr;
+   LeafInsertRequest lir;
+   TraverseRequest tr;
+   TraverseResponse trr;
+   TreeScanRequest tsr;
+   TreeScanResponse tsrr;
 };
 
 static constexpr uint64_t LARGEST_MESSAGE = sizeof(ALLDERIVED);
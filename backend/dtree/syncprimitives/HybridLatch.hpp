@@ -119,6 +119,16 @@ struct alignas(64) HybridLatch {
       smut.unlock();
    }
 
+   // unlatches and marks the latched object as obsolete (last version bit), optimistic readers restart
+   void unlatchExclusiveObsolete()
+   {
+      ensure(isLatched());
+      Version v = version.load();
+      v += 0b11;
+      version.store(v, std::memory_order_release);
+      smut.unlock();
+   }
+
    bool tryDowngradeExclusiveToShared(){
       ensure(isLatched());
       Version v = version.load();
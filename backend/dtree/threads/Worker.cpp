@@ -15,7 +15,10 @@ AbstractWorker::AbstractWorker(uint64_t workerId, std::string name, rdma::CM<rdm
       cm(cm),
       nodeId_(nodeId),
       cctxs(FLAGS_storage_nodes),
-      remote_caches(FLAGS_storage_nodes) {
+      remote_caches(FLAGS_storage_nodes),
+      remote_blob_heaps(FLAGS_storage_nodes),
+      metadataPages(FLAGS_storage_nodes),
+      split_hint_rings(FLAGS_storage_nodes) {
    barrier_buffer = (uint64_t*)cm.getGlobalBuffer().allocate(64, 64);
    // -------------------------------------------------------------------------------------
    // Connection to MessageHandler
@@ -53,6 +56,11 @@ AbstractWorker::AbstractWorker(uint64_t workerId, std::string name, rdma::CM<rdm
       auto& msg = *reinterpret_cast<InitMessage*>((cctxs[n_i].rctx->applicationData));
       remote_caches[n_i] = {.counter = RemotePtr(n_i, msg.remote_cache_counter),
                             .begin_offset = msg.remote_cache_offset};
+      remote_blob_heaps[n_i] = {.counter = RemotePtr(n_i, msg.remote_blob_counter),
+                                .begin_offset = msg.remote_blob_offset,
+                                .size = msg.remote_blob_size};
+      metadataPages[n_i] = RemotePtr(msg.nodeId, msg.metadataOffset);
+      split_hint_rings[n_i] = RemotePtr(msg.nodeId, msg.split_hint_ring);
       if (msg.nodeId == 0) {
          barrier = msg.barrierAddr;
          metadataPage = RemotePtr(msg.nodeId, msg.metadataOffset);
@@ -87,6 +95,10 @@ Worker::Worker(uint64_t workerId, std::string name, rdma::CM<rdma::InitMessage>&
       rmem.latch_buffer = (PageHeader*)cm.getGlobalBuffer().allocate(64, 64);
       if (!local_rmemory.try_push(rmem)) { throw std::logic_error("local rmemory failed"); }
    }
+   blob_buffer = (uint8_t*)cm.getGlobalBuffer().allocate(MAX_BLOB_SIZE * MAX_BLOB_BATCH, 64);
+   batch_buffer = (uint8_t*)cm.getGlobalBuffer().allocate(BATCH_BUFFER_BYTES, 64);
+   batch_headers = (uint8_t*)cm.getGlobalBuffer().allocate(CACHE_LINE * MAX_READ_BATCH, 64);
+   hint_buffer = (SplitHint*)cm.getGlobalBuffer().allocate(sizeof(SplitHint), 64);
 }
 }  // namespace onesided
 }  // namespace threads
@@ -2,7 +2,11 @@
 #include <alloca.h>
 #include <sys/types.h>
 
+#include <algorithm>
+#include <array>
+#include <cstddef>
 #include <cstdint>
+#include <cstring>
 #include <iostream>
 #include <span>
 #include <stdexcept>
@@ -49,15 +53,23 @@ struct AbstractWorker {
       RemotePtr counter;
       uintptr_t begin_offset;
    };
+   struct RemoteBlobInfo {
+      RemotePtr counter;
+      uintptr_t begin_offset;
+      uint64_t size;
+   };
    //
    rdma::CM<rdma::InitMessage>& cm;
    NodeID nodeId_;
    std::vector<ConnectionContext> cctxs;
    std::vector<RemoteCacheInfo> remote_caches;  // counter addr
+   std::vector<RemoteBlobInfo> remote_blob_heaps;
    uint64_t* barrier_buffer{nullptr};
    // -------------------------------------------------------------------------------------
    uintptr_t barrier;  // barrier address
    RemotePtr metadataPage;
+   std::vector<RemotePtr> metadataPages;  // metadata page of every storage node, used by the partitioned forest
+   std::vector<RemotePtr> split_hint_rings;
    // -------------------------------------------------------------------------------------
    AbstractWorker(uint64_t workerId, std::string name, rdma::CM<rdma::InitMessage>& cm, NodeID nodeId);
    virtual ~AbstractWorker();
@@ -88,12 +100,14 @@ struct AbstractWorker {
       }
    }
 
+   // bytes allows to send only the used part of variable-length messages
    template <typename MSG>
-   void writeMsg(NodeID nodeId, MSG& msg) {
+   void writeMsg(NodeID nodeId, MSG& msg, size_t bytes = sizeof(MSG)) {
+      ensure(bytes <= sizeof(MSG));
       rdma::completion signal = rdma::completion::signaled;
       uint8_t flag = 1;
       // -------------------------------------------------------------------------------------
-      rdma::postWrite(&msg, *(cctxs[nodeId].rctx), rdma::completion::unsignaled, cctxs[nodeId].plOffset);
+      rdma::postWrite(&msg, *(cctxs[nodeId].rctx), rdma::completion::unsignaled, cctxs[nodeId].plOffset, bytes);
       rdma::postWrite(&flag, *(cctxs[nodeId].rctx), signal, cctxs[nodeId].mbOffset);
       // -------------------------------------------------------------------------------------
       int comp{0};
@@ -102,13 +116,13 @@ struct AbstractWorker {
    }
 
    template <typename RESPONSE, typename MSG>
-   RESPONSE& writeMsgSync(NodeID nodeId, MSG& msg) {
+   RESPONSE& writeMsgSync(NodeID nodeId, MSG& msg, size_t bytes = sizeof(MSG)) {
       // -------------------------------------------------------------------------------------
       auto& response = *static_cast<RESPONSE*>(cctxs[nodeId].incoming);
       response.receiveFlag = 0;
       volatile uint8_t& received = response.receiveFlag;
       // -------------------------------------------------------------------------------------
-      writeMsg(nodeId, msg);
+      writeMsg(nodeId, msg, bytes);
       // -------------------------------------------------------------------------------------
       while (received == 0) { _mm_pause(); }
       return response;
@@ -148,14 +162,53 @@ struct Worker : public AbstractWorker {
    }
 
    std::span<KVPair> scan(NodeID nodeId, Key from, Key to) {
+      bool has_more = false;
+      return scan(nodeId, from, to, MAX_SCAN_RESULT, has_more);
+   }
+
+   // returns at most limit rows; if has_more is set the next page starts after the last returned key
+   std::span<KVPair> scan(NodeID nodeId, Key from, Key to, uint64_t limit, bool& has_more) {
       auto& request = *MessageFabric::createMessage<ScanRequest>(cctxs[nodeId].outgoing);
       request.nodeId = nodeId_;
       request.from = from;
       request.to = to;
+      request.limit = limit;
       auto& response = writeMsgSync<rdma::ScanResponse>(nodeId, request);
+      has_more = false;
       if (response.rc == rdma::RESULT::ABORTED) { return std::span<KVPair>(); }
+      has_more = response.has_more;
       return std::span<KVPair>(cctxs[nodeId].result_buffer, response.length);
    }
+   //=== two-sided variable-length key tree stub ===//
+   bool insert(NodeID nodeId, std::string_view key, Value value) {
+      auto& request = *MessageFabric::createMessage<VarInsertRequest>(cctxs[nodeId].outgoing);
+      request.nodeId = nodeId_;
+      request.value = value;
+      request.setKey(key);
+      auto& response = writeMsgSync<rdma::InsertResponse>(nodeId, request, request.bytes());
+      if (response.rc == rdma::RESULT::ABORTED) { return false; }
+      return true;
+   }
+
+   bool lookup(NodeID nodeId, std::string_view key, Value& returnValue) {
+      auto& request = *MessageFabric::createMessage<VarLookupRequest>(cctxs[nodeId].outgoing);
+      request.nodeId = nodeId_;
+      request.setKey(key);
+      auto& response = writeMsgSync<rdma::LookupResponse>(nodeId, request, request.bytes());
+      if (response.rc == rdma::RESULT::ABORTED) { return false; }
+      returnValue = response.value;
+      return true;
+   }
+
+   // result is encoded with rdma::VarScanEncoding
+   std::span<uint8_t> scan(NodeID nodeId, std::string_view from, std::string_view to) {
+      auto& request = *MessageFabric::createMessage<VarScanRequest>(cctxs[nodeId].outgoing);
+      request.nodeId = nodeId_;
+      request.setKeys(from, to);
+      auto& response = writeMsgSync<rdma::ScanResponse>(nodeId, request, request.bytes());
+      if (response.rc == rdma::RESULT::ABORTED) { return std::span<uint8_t>(); }
+      return std::span<uint8_t>(reinterpret_cast<uint8_t*>(cctxs[nodeId].result_buffer), response.length);
+   }
 };
 // -------------------------------------------------------------------------------------
 }  // namespace twosided
@@ -166,9 +219,34 @@ struct Worker : public AbstractWorker {
    static thread_local onesided::Worker* tlsPtr;
    static inline onesided::Worker& my() { return *onesided::Worker::tlsPtr; }
    utils::Stack<RemotePtr, TL_CACHE_SIZE> remote_pages;
+   // pages reserved on a specific storage node [next, end)
+   struct PageRange {
+      uint64_t next{0};
+      uint64_t end{0};
+   };
+   std::array<PageRange, MAX_NODES> page_ranges;
+   std::array<uint64_t, MAX_NODES> node_usage{};  // allocated pages per storage node as of our last FAA there
+   uint64_t next_round_robin{0};
    utils::Stack<RDMAMemoryInfo, CONCURRENT_LATCHES>
        local_rmemory;  // local rdma memory used by the latches not really nicely encapsulated but fine
 
+   // out-of-line values; payloads are staged in and fetched into slots of blob_buffer
+   uint8_t* blob_buffer{nullptr};
+   RemotePtr blob_chunk{NULL_REMOTEPTR};
+   uint64_t blob_chunk_used{BLOB_CHUNK_SIZE};
+   uint64_t blob_next_node{0};
+   // MAX_READ_BATCH nodes and headers for batched reads
+   static constexpr uint64_t BATCH_BUFFER_BYTES{THREAD_LOCAL_RDMA_BUFFER * MAX_READ_BATCH};
+   uint8_t* batch_buffer{nullptr};
+   uint8_t* batch_headers{nullptr};
+   SplitHint* hint_buffer{nullptr};
+   // contention met by the one-sided operations of this worker, sampled by the adaptive router
+   struct Contention {
+      uint64_t latch_failures{0};  // nodes found latched and lost CAS
+      uint64_t restarts{0};        // failed validations
+      uint64_t total() const { return latch_failures + restarts; }
+   } contention;
+
    Worker(uint64_t workerId, std::string name, rdma::CM<rdma::InitMessage>& cm, NodeID nodeId);
    ~Worker() = default;
 
@@ -212,6 +290,34 @@ struct Worker : public AbstractWorker {
          if (comp > 0 && wcReturn.status != IBV_WC_SUCCESS) throw;
       }
    }
+   // writes [offset, offset + bytes) of the local copy to the same offset of the remote object
+   void remote_write_range(RemotePtr remote_ptr, void* /*RDMA memory*/ local_copy, size_t offset, size_t bytes) {
+      ensure(offset + bytes <= THREAD_LOCAL_RDMA_BUFFER);
+      auto nodeId = remote_ptr.getOwner();
+      auto addr = remote_ptr.plainOffset() + offset;
+      auto* local = static_cast<uint8_t*>(local_copy) + offset;
+      rdma::postWrite(local, *(cctxs[nodeId].rctx), rdma::completion::signaled, addr, bytes);
+      int comp{0};
+      ibv_wc wcReturn;
+      while (comp == 0) {
+         comp = rdma::pollCompletion(cctxs[nodeId].rctx->id->qp->send_cq, 1, &wcReturn);
+         if (comp > 0 && wcReturn.status != IBV_WC_SUCCESS) throw;
+      }
+   }
+   // reads [offset, offset + bytes) of the remote object into the same offset of the local copy
+   void remote_read_range(RemotePtr remote_ptr, void* /*RDMA memory*/ local_copy, size_t offset, size_t bytes) {
+      ensure(offset + bytes <= THREAD_LOCAL_RDMA_BUFFER);
+      auto nodeId = remote_ptr.getOwner();
+      auto addr = remote_ptr.plainOffset() + offset;
+      auto* local = static_cast<uint8_t*>(local_copy) + offset;
+      rdma::postRead(local, *(cctxs[nodeId].rctx), rdma::completion::signaled, addr, bytes, 0);
+      int comp{0};
+      ibv_wc wcReturn;
+      while (comp == 0) {
+         comp = rdma::pollCompletion(cctxs[nodeId].rctx->id->qp->send_cq, 1, &wcReturn);
+         if (comp > 0 && wcReturn.status != IBV_WC_SUCCESS) throw;
+      }
+   }
    void poll_async_completion(RemotePtr remote_ptr){
       auto nodeId = remote_ptr.getOwner();
       [[maybe_unused]] auto addr = remote_ptr.plainOffset();
@@ -227,6 +333,7 @@ struct Worker : public AbstractWorker {
       for (size_t i = 0; i < FLAGS_storage_nodes; i++) {
          auto begin_idx =
              fetchAdd(per_node_cache, remote_caches[i].counter, rdma::completion::signaled, barrier_buffer);
+         node_usage[i] = begin_idx + per_node_cache;
          for (auto p_idx = begin_idx; p_idx < begin_idx + per_node_cache; p_idx++) {
             RemotePtr addr(i, (p_idx * BTREE_NODE_SIZE) + remote_caches[i].begin_offset);
             ensure(remote_pages.try_push(addr));
@@ -234,6 +341,205 @@ struct Worker : public AbstractWorker {
       }
       remote_pages.shuffle();
    }
+   // page on the given storage node, every node hands out TL_CACHE_SIZE pages per FAA
+   RemotePtr allocate_page(NodeID n_i) {
+      auto& range = page_ranges[n_i];
+      if (range.next == range.end) {
+         range.next = fetchAdd(TL_CACHE_SIZE, remote_caches[n_i].counter, rdma::completion::signaled, barrier_buffer);
+         range.end = range.next + TL_CACHE_SIZE;
+         node_usage[n_i] = range.end;
+      }
+      return RemotePtr(n_i, (range.next++ * BTREE_NODE_SIZE) + remote_caches[n_i].begin_offset);
+   }
+   // storage node for a page split off from sibling; parent is NULL_REMOTEPTR for the root.
+   // EMPTY_NODEID leaves the choice to the shuffled page cache
+   NodeID place(AllocationPolicy policy, RemotePtr sibling, RemotePtr parent) {
+      switch (policy) {
+         case AllocationPolicy::RANDOM:
+            return EMPTY_NODEID;
+         case AllocationPolicy::SIBLING:
+            return sibling.getOwner();
+         case AllocationPolicy::PARENT:
+            return (parent == NULL_REMOTEPTR) ? sibling.getOwner() : parent.getOwner();
+         case AllocationPolicy::ROUND_ROBIN:
+            return static_cast<NodeID>(next_round_robin++ % FLAGS_storage_nodes);
+         case AllocationPolicy::LEAST_LOADED: {
+            auto least = std::min_element(node_usage.begin(), node_usage.begin() + FLAGS_storage_nodes);
+            return static_cast<NodeID>(std::distance(node_usage.begin(), least));
+         }
+      }
+      return EMPTY_NODEID;
+   }
+
+   // upsert applied by the storage node owning leaf; false if the insert has to be done one-sided
+   bool leaf_insert(RemotePtr leaf, Key key, Value value) {
+      auto nodeId = leaf.getOwner();
+      auto& request = *MessageFabric::createMessage<LeafInsertRequest>(cctxs[nodeId].outgoing);
+      request.nodeId = nodeId_;
+      request.leaf = leaf.offset;
+      request.key = key;
+      request.value = value;
+      auto& response = writeMsgSync<rdma::InsertResponse>(nodeId, request);
+      return response.rc == rdma::RESULT::COMMITTED;
+   }
+   // descent towards key by the storage node owning start (the metadata page if from_metadata)
+   rdma::TraverseResponse traverse(RemotePtr start, bool from_metadata, Key key) {
+      auto nodeId = start.getOwner();
+      auto& request = *MessageFabric::createMessage<TraverseRequest>(cctxs[nodeId].outgoing);
+      request.nodeId = nodeId_;
+      request.start = start.offset;
+      request.from_metadata = from_metadata;
+      request.key = key;
+      return writeMsgSync<rdma::TraverseResponse>(nodeId, request);
+   }
+   // scan executed by the storage node owning start; the rows are valid until the next request to that node
+   rdma::TreeScanResponse tree_scan(RemotePtr start, bool from_metadata, Key from, Key to, uint64_t limit,
+                                    std::span<KVPair>& rows) {
+      auto nodeId = start.getOwner();
+      auto& request = *MessageFabric::createMessage<TreeScanRequest>(cctxs[nodeId].outgoing);
+      request.nodeId = nodeId_;
+      request.start = start.offset;
+      request.from_metadata = from_metadata;
+      request.from = from;
+      request.to = to;
+      request.limit = limit;
+      auto& response = writeMsgSync<rdma::TreeScanResponse>(nodeId, request);
+      rows = std::span<KVPair>(cctxs[nodeId].result_buffer, response.length);
+      return response;
+   }
+   // CAS on the value slot of a leaf that is registered with as updater, which keeps exclusive latches off it.
+   // BUSY: the leaf is exclusively latched; CHANGED: the leaf got a new version or the value changed since the
+   // optimistic read that found the slot
+   enum class InPlace { APPLIED, BUSY, CHANGED };
+   // three round trips: registration and header READ share a chain, the CAS depends on the header, version increment
+   // and deregistration share the last chain. RC executes the work requests of a chain in order, hence the READ
+   // returns the header after the registration
+   InPlace update_in_place(RemotePtr page, Version version, RemotePtr slot, uint64_t expected, uint64_t desired) {
+      auto nodeId = page.getOwner();
+      auto& context = *(cctxs[nodeId].rctx);
+      auto await = [&]() {
+         int comp{0};
+         ibv_wc wcReturn;
+         while (comp == 0) {
+            comp = rdma::pollCompletion(context.id->qp->send_cq, 1, &wcReturn);
+            if (comp > 0 && wcReturn.status != IBV_WC_SUCCESS) throw;
+         }
+      };
+      rdma::WorkRequestChain<2> chain;
+      chain.fetchAdd(1, barrier_buffer, page.plainOffset());  // register
+      chain.read(batch_header(0), sizeof(PageHeader), page.plainOffset());
+      chain.post(context, rdma::completion::signaled);
+      await();
+      auto result = InPlace::BUSY;
+      if (!exclusively_latched(*barrier_buffer)) {
+         result = InPlace::CHANGED;
+         if (batch_header(0)->version == version &&
+             compareSwap(expected, desired, slot, rdma::completion::signaled, barrier_buffer)) {
+            // optimistic readers of the leaf restart
+            chain.fetchAdd(1, barrier_buffer, page.plainOffset() + offsetof(PageHeader, version));
+            result = InPlace::APPLIED;
+         }
+      }
+      chain.fetchAdd(~uint64_t(0), barrier_buffer, page.plainOffset());  // deregister, also after a BUSY registration
+      chain.post(context, rdma::completion::signaled);
+      await();
+      return result;
+   }
+   // announces node, which filled up below parent, to the split daemon of the parent's storage node
+   void post_split_hint(RemotePtr parent, RemotePtr node) {
+      auto ring = split_hint_rings[parent.getOwner()];
+      auto position = fetchAdd(1, ring, rdma::completion::signaled, barrier_buffer);
+      *hint_buffer = {parent.offset, node.offset, position + 1};
+      RemotePtr slot(ring.offset + offsetof(SplitHintRing, slots) + ((position % SPLIT_HINT_SLOTS) * sizeof(SplitHint)));
+      remote_write<SplitHint>(slot, hint_buffer, rdma::completion::signaled);
+   }
+
+   //=== out-of-line values ===//
+   uint8_t* blob_slot(size_t slot) { return blob_buffer + (slot * MAX_BLOB_SIZE); }
+
+   // bump allocation in a worker-private chunk, chunks are reserved round robin across the storage nodes
+   RemotePtr allocate_blob(uint64_t length) {
+      ensure(length <= MAX_BLOB_SIZE);
+      length = (length + 7) & ~uint64_t(7);
+      if (blob_chunk_used + length > BLOB_CHUNK_SIZE) {
+         for (size_t attempt = 0;; attempt++) {
+            if (attempt == FLAGS_storage_nodes) { throw std::runtime_error("blob heaps exhausted"); }
+            auto n_i = blob_next_node++ % FLAGS_storage_nodes;
+            auto& heap = remote_blob_heaps[n_i];
+            auto begin = fetchAdd(BLOB_CHUNK_SIZE, heap.counter, rdma::completion::signaled, barrier_buffer);
+            if (begin + BLOB_CHUNK_SIZE > heap.size) continue;
+            blob_chunk = RemotePtr(n_i, heap.begin_offset + begin);
+            blob_chunk_used = 0;
+            break;
+         }
+      }
+      RemotePtr blob(blob_chunk.offset + blob_chunk_used);
+      blob_chunk_used += length;
+      return blob;
+   }
+
+   void write_blob(RemotePtr remote_ptr, const void* data, uint64_t length) {
+      ensure(length <= MAX_BLOB_SIZE);
+      auto nodeId = remote_ptr.getOwner();
+      std::memcpy(blob_slot(0), data, length);
+      rdma::postWrite(blob_slot(0), *(cctxs[nodeId].rctx), rdma::completion::signaled, remote_ptr.plainOffset(), length);
+      int comp{0};
+      ibv_wc wcReturn;
+      while (comp == 0) {
+         comp = rdma::pollCompletion(cctxs[nodeId].rctx->id->qp->send_cq, 1, &wcReturn);
+         if (comp > 0 && wcReturn.status != IBV_WC_SUCCESS) throw;
+      }
+   }
+
+   // reads refs[i] into blob_slot(i); all READs are posted before the first completion is polled
+   void read_blobs(const BlobRef* refs, size_t count) {
+      ensure(count <= MAX_BLOB_BATCH);
+      std::array<ReadRequest, MAX_BLOB_BATCH> reads;
+      for (size_t r_i = 0; r_i < count; r_i++) {
+         ensure(refs[r_i].length <= MAX_BLOB_SIZE);
+         reads[r_i] = {refs[r_i].ptr, blob_slot(r_i), refs[r_i].length};
+      }
+      read_batch(reads.data(), count);
+   }
+
+   //=== batched reads ===//
+   struct ReadRequest {
+      RemotePtr remote_ptr;
+      void* local_copy;  // RDMA memory
+      size_t bytes;
+   };
+   // posts the READs of each node as one chain with a single doorbell before the first completion is polled. A batch
+   // is larger than the send CQ, hence only the last READ of a chain is signaled; an unsignaled READ that fails still
+   // reports its error
+   void read_batch(const ReadRequest* reads, size_t count) {
+      ensure(count <= MAX_BLOB_BATCH);
+      rdma::WorkRequestChain<MAX_BLOB_BATCH> chain;
+      std::array<bool, MAX_NODES> outstanding{};
+      for (size_t n_i = 0; n_i < FLAGS_storage_nodes; n_i++) {
+         for (size_t r_i = 0; r_i < count; r_i++) {
+            RemotePtr remote_ptr = reads[r_i].remote_ptr;
+            if (remote_ptr.getOwner() != n_i) continue;
+            chain.read(reads[r_i].local_copy, reads[r_i].bytes, remote_ptr.plainOffset(), r_i);
+         }
+         if (chain.empty()) continue;
+         chain.post(*(cctxs[n_i].rctx), rdma::completion::signaled);
+         outstanding[n_i] = true;
+      }
+      for (size_t n_i = 0; n_i < FLAGS_storage_nodes; n_i++) {
+         if (!outstanding[n_i]) continue;
+         int comp{0};
+         ibv_wc wcReturn;
+         while (comp == 0) {
+            comp = rdma::pollCompletion(cctxs[n_i].rctx->id->qp->send_cq, 1, &wcReturn);
+            if (comp > 0 && wcReturn.status != IBV_WC_SUCCESS) throw;
+         }
+      }
+   }
+   // scratch memory for batched node reads, independent of the latch memory
+   uint8_t* batch_node(size_t slot) { return batch_buffer + (slot * THREAD_LOCAL_RDMA_BUFFER); }
+   PageHeader* batch_header(size_t slot) {
+      return static_cast<PageHeader*>(static_cast<void*>(batch_headers + (slot * CACHE_LINE)));
+   }
 
    // returns old value; before increment
    uint64_t fetchAdd(uint64_t increment, RemotePtr remote_ptr, rdma::completion wc,
@@ -0,0 +1,257 @@
+#include "Defs.hpp"
+#include "PerfEvent.hpp"
+#include "dtree/Compute.hpp"
+#include "dtree/db/OneSidedBTree.hpp"
+#include "dtree/db/OneSidedHybridTree.hpp"
+#include "dtree/db/OneSidedLatches.hpp"
+#include "dtree/db/OneSidedRouter.hpp"
+#include "dtree/db/OneSidedTypes.hpp"
+#include "dtree/Config.hpp"
+#include "dtree/Storage.hpp"
+#include "dtree/profiling/ProfilingThread.hpp"
+#include "dtree/profiling/counters/WorkerCounters.hpp"
+#include "dtree/threads/Concurrency.hpp"
+#include "dtree/threads/Worker.hpp"
+#include "dtree/utils/RandomGenerator.hpp"
+#include "dtree/utils/Time.hpp"
+// -------------------------------------------------------------------------------------
+#include <gflags/gflags.h>
+// -------------------------------------------------------------------------------------
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <stdexcept>
+#include <vector>
+// -------------------------------------------------------------------------------------
+// runs the same workload against the two-sided tree, the one-sided tree, the hybrid tree and the adaptive router
+DEFINE_string(design, "hybrid", "onesided, shared (one-sided, leaves are read under reader-counted shared latches "
+                                "instead of optimistically), twosided, hybrid (inner nodes traversed by the storage "
+                                "nodes, leaves accessed one-sided) or adaptive (per key range one-sided or executed by "
+                                "the storage nodes)");
+DEFINE_uint64(keys, 100, "Number keys accross all nodes");
+DEFINE_uint64(cid, 0, "Compute node id");
+DEFINE_uint32(read_ratio, 100, "");
+DEFINE_bool(scans, false, "use scans");
+// selectivity values from paper  0.001 (0.1%), 0.01 (1%), 0.1 (10%)
+DEFINE_double(scan_selectivity, 0.01, "scan selectivity");
+DEFINE_uint32(run_for_seconds, 5, "");
+
+//=== Partitioning ===//
+// equi partitioning
+std::pair<Key, Key> equi_partition(uint64_t id, uint64_t participants, uint64_t N) {
+   const uint64_t blockSize = N / participants;
+   auto begin = id * blockSize;
+   auto end = begin + blockSize;
+   if (id == participants - 1) end = N;
+   return {begin, end};
+}
+
+//=== Profiling ===//
+struct ProfilingInfo : public dtree::profiling::WorkloadInfo {
+   std::string experiment;
+   uint64_t elements;
+   uint64_t readRatio;
+   std::string design;
+   uint64_t timestamp = 0;
+
+   ProfilingInfo(std::string experiment, uint64_t elements, uint64_t readRatio, std::string design)
+       : experiment(experiment), elements(elements), readRatio(readRatio), design(design) {}
+
+   virtual std::vector<std::string> getRow() {
+      return {
+          experiment, std::to_string(elements), std::to_string(readRatio), design, std::to_string(timestamp++),
+      };
+   }
+
+   virtual std::vector<std::string> getHeader() { return {"workload", "elements", "read ratio", "design", "timestamp"}; }
+
+   virtual void csv(std::ofstream& file) override {
+      file << experiment << " , ";
+      file << elements << " , ";
+      file << readRatio << " , ";
+      file << design << " , ";
+      file << timestamp << " , ";
+   }
+   virtual void csvHeader(std::ofstream& file) override {
+      file << "Workload"
+           << " , ";
+      file << "Elements"
+           << " , ";
+      file << "ReadRatio"
+           << " , ";
+      file << "Design"
+           << " , ";
+      file << "Timestamp"
+           << " , ";
+   }
+};
+
+//=== Two-sided design ===//
+// the key space is equi partitioned over the storage nodes, each holds a two-sided tree for its partition
+struct TwoSidedIndex {
+   const uint64_t partition_size = FLAGS_keys / FLAGS_storage_nodes;
+
+   NodeID route(Key key) { return static_cast<NodeID>(std::min<uint64_t>(key / partition_size, FLAGS_storage_nodes - 1)); }
+   bool lookup(Key key, Value& retValue) { return dtree::threads::twosided::Worker::my().lookup(route(key), key, retValue); }
+   void insert(Key key, Value value) {
+      if (!dtree::threads::twosided::Worker::my().insert(route(key), key, value)) throw std::logic_error("insert failed");
+   }
+   // one request per partition and result page
+   template <typename FN>
+   void range_scan(Key from, const Key to, FN scan_function) {
+      while (from <= to) {
+         auto node = route(from);
+         auto end = (node == FLAGS_storage_nodes - 1) ? to : std::min(to, (node + 1) * partition_size - 1);
+         bool has_more = false;
+         auto kv_span = dtree::threads::twosided::Worker::my().scan(node, from, end, MAX_SCAN_RESULT, has_more);
+         for (auto& kv : kv_span) scan_function(kv.key, kv.value);
+         if (has_more && !kv_span.empty()) {
+            from = kv_span.back().key + 1;
+            continue;
+         }
+         if (end == to) return;
+         from = end + 1;
+      }
+   }
+};
+
+//=== Storage Logic ===//
+void storage_node() {
+   using namespace dtree;
+   Storage store;
+   profiling::EmptyWorkloadInfo wl;
+   store.startProfiler(wl);
+   store.startMessageHandler();
+   if (FLAGS_split_hints) store.startMaintenance();
+   {
+      while (store.getConnectedClients() == 0)
+         ;
+      [[maybe_unused]] dtree::RemoteGuard rguard(store.getConnectedClients());
+   }
+   std::cout << "Stopped Profiler" << std::endl;
+   store.stopProfiler();
+}
+
+//=== Compute Logic ===//
+// make_index constructs the index handle of the calling worker thread
+template <typename WorkerType, typename MakeIndex>
+void compute_node(MakeIndex make_index) {
+   using namespace dtree;
+   std::cout << "started compute node" << std::endl;
+   Compute<WorkerType> comp;
+   comp.startAndConnect();
+   //=== Barrier ===//
+   uint64_t barrier_stage = 1;
+   auto barrier_wait = [&]() {
+      for (uint64_t t_i = 0; t_i < FLAGS_worker; ++t_i) {
+         comp.getWorkerPool().scheduleJobAsync(t_i, [&, t_i]() { WorkerType::my().rdma_barrier_wait(barrier_stage); });
+      }
+      comp.getWorkerPool().joinAll();
+      barrier_stage++;
+   };
+   //=== build tree ===//
+   // get compute node partition
+   const auto part = equi_partition(FLAGS_cid, FLAGS_compute_nodes, FLAGS_keys);
+   for (uint64_t t_i = 0; t_i < FLAGS_worker; ++t_i) {
+      comp.getWorkerPool().scheduleJobAsync(t_i, [&, t_i]() {
+         auto index = make_index();
+         auto nodeKeys = part.second - part.first;
+         auto threadPartition = equi_partition(t_i, FLAGS_worker, nodeKeys);
+         auto begin = part.first + threadPartition.first;
+         auto end = part.first + threadPartition.second;
+         for (Key k = begin; k < end; ++k) {
+            index.insert(k, k);
+            WorkerType::my().counters.incr(profiling::WorkerCounters::tx_p);
+         }
+      });
+   }
+
+   barrier_wait();
+   //=== Benchmark ===//
+   std::string benchmark = (FLAGS_scans) ? "scans" : "point queries";
+   ProfilingInfo pf{benchmark, FLAGS_keys, FLAGS_read_ratio, FLAGS_design};
+   comp.startProfiler(pf);
+   std::atomic<bool> keep_running = true;
+   std::atomic<u64> running_threads_counter = 0;
+   for (uint64_t t_i = 0; t_i < FLAGS_worker; ++t_i) {
+      comp.getWorkerPool().scheduleJobAsync(t_i, [&, t_i]() {
+         running_threads_counter++;
+         auto index = make_index();
+         for (; keep_running; WorkerType::my().counters.incr(profiling::WorkerCounters::tx_p)) {
+            //=== Scan ===//
+            if (FLAGS_scans) {
+               auto begin = utils::getTimePoint();
+               auto expected_values = static_cast<uint64_t>((double)(FLAGS_keys)*FLAGS_scan_selectivity);
+               auto start = utils::RandomGenerator::getRandU64(0, FLAGS_keys - expected_values);
+               auto next = start;
+               index.range_scan(start, start + expected_values, [&](const Key& key, [[maybe_unused]] const Value& value) {
+                  if (key != next)
+                     throw std::logic_error("Key not as expected " + std::to_string(key) + " vs " + std::to_string(next));
+                  next++;
+               });
+               if (next == start) throw std::logic_error("empty scan from " + std::to_string(start));
+               if (next < start + expected_values)
+                  throw std::logic_error("scan from " + std::to_string(start) + " ended at " + std::to_string(next));
+               WorkerType::my().counters.incr_by(profiling::WorkerCounters::latency, utils::getTimePoint() - begin);
+               continue;
+            }
+            //=== Upsert and Lookups ===//
+            auto begin = utils::getTimePoint();
+            Key key = utils::RandomGenerator::getRandU64(0, FLAGS_keys);
+            if (FLAGS_read_ratio == 100 || utils::RandomGenerator::getRandU64(0, 100) < FLAGS_read_ratio) {
+               Value rValue{0};
+               if (!index.lookup(key, rValue)) throw std::logic_error("key not found");
+            } else {
+               index.insert(key, utils::RandomGenerator::getRandU64Fast());
+            }
+            WorkerType::my().counters.incr_by(profiling::WorkerCounters::latency, utils::getTimePoint() - begin);
+         }
+         running_threads_counter--;
+      });
+   }
+   sleep(FLAGS_run_for_seconds);
+   keep_running = false;
+   while (running_threads_counter) _mm_pause();
+   comp.getWorkerPool().joinAll();
+   comp.stopProfiler();
+}
+
+//=== Main ===//
+int main(int argc, char* argv[]) {
+   using namespace dtree;
+   gflags::SetUsageMessage("Dtree Frontend");
+   gflags::ParseCommandLineFlags(&argc, &argv, true);
+   if (FLAGS_keys % fLU64::FLAGS_storage_nodes != 0) {
+      throw std::invalid_argument("Number keys must be dividable by the number of storage nodes");
+   }
+   if (FLAGS_design != "onesided" && FLAGS_design != "shared" && FLAGS_design != "twosided" &&
+       FLAGS_design != "hybrid" && FLAGS_design != "adaptive") {
+      throw std::invalid_argument("unknown design " + FLAGS_design);
+   }
+
+   if (FLAGS_storage_node) {
+      storage_node();
+   } else if (FLAGS_design == "twosided") {
+      compute_node<threads::twosided::Worker>([]() { return TwoSidedIndex(); });
+   } else if (FLAGS_design == "onesided") {
+      compute_node<threads::onesided::Worker>(
+          []() { return onesided::BTree<Key, Value>(threads::onesided::Worker::my().metadataPage); });
+   } else if (FLAGS_design == "shared") {
+      using SharedTree = onesided::BTree<Key, Value, onesided::ActiveLeaf<Key, Value>, onesided::SharedReads>;
+      compute_node<threads::onesided::Worker>(
+          []() { return SharedTree(threads::onesided::Worker::my().metadataPage); });
+   } else if (FLAGS_design == "hybrid") {
+      // splits place the new node on the storage node of its parent regardless of --allocation_policy, a path then
+      // stays on one storage node below the root and the traversal costs one or two RPCs instead of one per level
+      compute_node<threads::onesided::Worker>([]() {
+         return onesided::HybridTree<Key, Value>(threads::onesided::Worker::my().metadataPage,
+                                                 onesided::AllocationPolicy::PARENT);
+      });
+   } else {
+      compute_node<threads::onesided::Worker>([]() {
+         return onesided::AdaptiveRouter<Key, Value>(threads::onesided::Worker::my().metadataPage, FLAGS_keys);
+      });
+   }
+   return 0;
+}
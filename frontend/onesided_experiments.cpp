@@ -1,7 +1,10 @@
 #include "Defs.hpp"
 #include "PerfEvent.hpp"
 #include "dtree/Compute.hpp"
+#include "dtree/db/OneSidedBLinkTree.hpp"
 #include "dtree/db/OneSidedBTree.hpp"
+#include "dtree/db/OneSidedForest.hpp"
+#include "dtree/db/OneSidedBlobTree.hpp"
 #include "dtree/db/OneSidedLatches.hpp"
 #include "dtree/db/OneSidedTypes.hpp"
 #include "dtree/Config.hpp"
@@ -15,11 +18,15 @@
 // -------------------------------------------------------------------------------------
 #include <gflags/gflags.h>
 // -------------------------------------------------------------------------------------
+#include <algorithm>
 #include <charconv>
 #include <chrono>
+#include <cstring>
 #include <fstream>
 #include <iostream>
 #include <random>
+#include <span>
+#include <vector>
 // -------------------------------------------------------------------------------------
 DEFINE_string(percentage_keys, "",
               "percentage of keys per node, must be space delimited and integer scaled 100 -> 1.0");
@@ -29,7 +36,15 @@ DEFINE_uint32(read_ratio, 100, "");
 DEFINE_bool(scans, false, "use scans");
 // selectivity values from paper  0.001 (0.1%), 0.01 (1%), 0.1 (10%)
 DEFINE_double(scan_selectivity, 0.01, "scan selectivity");
+DEFINE_uint64(scan_page_size, 0, "0 scans with callbacks, otherwise scans are paginated with cursors of this many rows");
 DEFINE_uint32(run_for_seconds, 5, "");
+DEFINE_uint64(value_bytes, 0, "0 stores 8 byte values inline, otherwise values of this size are stored out of line "
+                              "(storage nodes need --blob_heap_percentage)");
+DEFINE_bool(blink, false, "use the B-link variant of the tree, splits latch only the split node (compare with "
+                          "--read_ratio < 100 and --percentage_keys for skewed inserts)");
+DEFINE_bool(forest, false, "every storage node holds an independent tree for its key range (see --percentage_keys)");
+DEFINE_bool(rmw, false, "writes are read-modify-writes that increment the value with one traversal instead of "
+                        "upserts");
 
 //=== Input parsing ===//
 static std::vector<unsigned> interpretGflagString(std::string_view desc) {
@@ -114,6 +129,7 @@ void storage_node() {
    profiling::EmptyWorkloadInfo wl;
    store.startProfiler(wl);
    store.startMessageHandler();
+   if (FLAGS_split_hints || FLAGS_cluster_leaves) store.startMaintenance();
    {
       while (store.getConnectedClients() == 0)
          ;
@@ -153,6 +169,30 @@ int main(int argc, char* argv[]) {
          partition_map.push_back(partition(s_i, percentage_keys, FLAGS_keys));
    }
 
+   if (FLAGS_value_bytes > MAX_BLOB_SIZE) {
+      throw std::invalid_argument("value_bytes must not exceed " + std::to_string(MAX_BLOB_SIZE));
+   }
+   if (FLAGS_blink && (FLAGS_value_bytes || FLAGS_scan_page_size)) {
+      throw std::invalid_argument("blink supports neither out-of-line values nor paginated scans");
+   }
+   if (FLAGS_forest && (FLAGS_blink || FLAGS_value_bytes || FLAGS_scan_page_size)) {
+      throw std::invalid_argument("forest supports neither blink, out-of-line values nor paginated scans");
+   }
+   if (FLAGS_cluster_leaves && (FLAGS_blink || FLAGS_forest || FLAGS_value_bytes)) {
+      throw std::invalid_argument("leaves are only clustered in the plain tree");
+   }
+   if (FLAGS_rmw && (FLAGS_blink || FLAGS_forest || FLAGS_value_bytes)) {
+      throw std::invalid_argument("read-modify-writes are only supported by the plain tree");
+   }
+   // routing table of the forest, partition p belongs to storage node p
+   std::vector<Key> forest_bounds;
+   for (auto& p : partition_map) forest_bounds.push_back(p.first);
+   // out-of-line payloads carry the key in their first bytes to validate lookups
+   auto make_payload = [](std::vector<uint8_t>& payload, Key key) {
+      std::fill(payload.begin(), payload.end(), static_cast<uint8_t>(key));
+      std::memcpy(payload.data(), &key, std::min(sizeof(Key), payload.size()));
+   };
+
    if (FLAGS_storage_node) {
       storage_node();
    } else {
@@ -179,10 +219,23 @@ int main(int argc, char* argv[]) {
             auto begin = part.first + threadPartition.first;
             auto end = part.first + threadPartition.second;
             onesided::BTree<Key, Value> tree(threads::onesided::Worker::my().metadataPage);
+            onesided::BLinkTree<Key, Value> blink_tree(threads::onesided::Worker::my().metadataPage);
+            onesided::Forest<Key, Value> forest(threads::onesided::Worker::my().metadataPages, forest_bounds);
+            onesided::BlobBTree<Key> blob_tree(threads::onesided::Worker::my().metadataPage);
+            std::vector<uint8_t> payload(FLAGS_value_bytes);
             for (Key k = begin; k < end; ++k) {
                [[maybe_unused]] auto p_id = get_partition(k);
-               Value v = k;
-               tree.insert(k,v);
+               if (FLAGS_value_bytes) {
+                  make_payload(payload, k);
+                  blob_tree.insert(k, payload.data(), payload.size());
+               } else if (FLAGS_blink) {
+                  blink_tree.insert(k, k);
+               } else if (FLAGS_forest) {
+                  forest.insert(k, k);
+               } else {
+                  Value v = k;
+                  tree.insert(k, v);
+               }
                threads::onesided::Worker::my().counters.incr(profiling::WorkerCounters::tx_p);
             }
          });
@@ -191,6 +244,11 @@ int main(int argc, char* argv[]) {
       barrier_wait();
       //=== Benchmark ===//
       std::string benchmark = (FLAGS_scans) ? "one-sided scans" : "one-sided point queries";
+      if (FLAGS_blink) benchmark += " (B-link)";
+      if (FLAGS_forest) benchmark += " (forest)";
+      if (FLAGS_rmw) benchmark += " (read-modify-write)";
+      if (FLAGS_in_place_updates) benchmark += " (in-place)";
+      if (FLAGS_leaf_cache_mb) benchmark += " (leaf cache)";
       ProfilingInfo pf{benchmark, FLAGS_keys, FLAGS_read_ratio, skew};
       comp.startProfiler(pf);
       std::atomic<bool> keep_running = true;
@@ -199,6 +257,10 @@ int main(int argc, char* argv[]) {
          comp.getWorkerPool().scheduleJobAsync(t_i, [&, t_i]() {
             running_threads_counter++;
             onesided::BTree<Key, Value> tree(threads::onesided::Worker::my().metadataPage);
+            onesided::BLinkTree<Key, Value> blink_tree(threads::onesided::Worker::my().metadataPage);
+            onesided::Forest<Key, Value> forest(threads::onesided::Worker::my().metadataPages, forest_bounds);
+            onesided::BlobBTree<Key> blob_tree(threads::onesided::Worker::my().metadataPage);
+            std::vector<uint8_t> payload(FLAGS_value_bytes);
             for (; keep_running; threads::onesided::Worker::my().counters.incr(profiling::WorkerCounters::tx_p)) {
                //=== Scan ===//
                if (FLAGS_scans) {
@@ -211,11 +273,37 @@ int main(int argc, char* argv[]) {
                   auto start = utils::RandomGenerator::getRandU64(pp.first, pp.second - expected_values);
                   std::vector<Key> result_set;
                   result_set.reserve(expected_values);
-                  tree.range_scan(
-                      start, start + expected_values, [&](Key& key, [[maybe_unused]] Value value) { result_set.push_back(key); },
-                      [&]() {
-                         result_set.clear();
-                      });
+                  // scans over out-of-line values only return the references
+                  auto scan = [&](auto& scanned_tree) {
+                     if (FLAGS_scan_page_size == 0) {
+                        scanned_tree.range_scan(start, start + expected_values,
+                                                [&](Key& key, [[maybe_unused]] auto value) { result_set.push_back(key); });
+                        return;
+                     }
+                     using Tree = std::remove_reference_t<decltype(scanned_tree)>;
+                     onesided::ScanToken<Key> token;
+                     for (bool first_page = true; first_page || !token.exhausted; first_page = false) {
+                        auto cursor = first_page
+                                          ? onesided::Cursor<Tree>(scanned_tree, start, start + expected_values, FLAGS_scan_page_size)
+                                          : onesided::Cursor<Tree>(scanned_tree, token, start + expected_values, FLAGS_scan_page_size);
+                        Key key;
+                        typename Tree::ValueType value;
+                        uint64_t rows = 0;
+                        for (; cursor.next(key, value); rows++) result_set.push_back(key);
+                        token = cursor.token();
+                        if (rows < FLAGS_scan_page_size) break;
+                     }
+                  };
+                  if (FLAGS_value_bytes)
+                     scan(blob_tree.tree);
+                  else if (FLAGS_blink)
+                     blink_tree.range_scan(start, start + expected_values,
+                                           [&](Key& key, [[maybe_unused]] Value value) { result_set.push_back(key); });
+                  else if (FLAGS_forest)
+                     forest.range_scan(start, start + expected_values,
+                                       [&](Key& key, [[maybe_unused]] Value value) { result_set.push_back(key); });
+                  else
+                     scan(tree);
                   
                   std::for_each (std::begin(result_set), std::end(result_set), [&](Key& key) {
                      ensure(key == start);
@@ -230,12 +318,33 @@ int main(int argc, char* argv[]) {
                auto begin = utils::getTimePoint();
                Key key = utils::RandomGenerator::getRandU64(0, FLAGS_keys);
                if (FLAGS_read_ratio == 100 || utils::RandomGenerator::getRandU64(0, 100) < FLAGS_read_ratio) {
-                  Value rValue{0};
-                  auto found = tree.lookup(key, rValue);
-                  if (!found) throw std::logic_error("key not found");
+                  if (FLAGS_value_bytes) {
+                     std::span<uint8_t> rValue;
+                     auto found = blob_tree.lookup(key, rValue);
+                     if (!found) throw std::logic_error("key not found");
+                     ensure(rValue.size() == FLAGS_value_bytes);
+                  } else {
+                     Value rValue{0};
+                     auto found = FLAGS_blink    ? blink_tree.lookup(key, rValue)
+                                  : FLAGS_forest ? forest.lookup(key, rValue)
+                                                 : tree.lookup(key, rValue);
+                     if (!found) throw std::logic_error("key not found");
+                  }
                } else {
-                  Value value = utils::RandomGenerator::getRandU64Fast();
-                  tree.insert(key, value);
+                  if (FLAGS_value_bytes) {
+                     make_payload(payload, key);
+                     blob_tree.insert(key, payload.data(), payload.size());
+                  } else {
+                     Value value = utils::RandomGenerator::getRandU64Fast();
+                     if (FLAGS_blink)
+                        blink_tree.insert(key, value);
+                     else if (FLAGS_forest)
+                        forest.insert(key, value);
+                     else if (FLAGS_rmw) {
+                        if (!tree.update(key, [](Value& v) { v++; })) throw std::logic_error("key not found");
+                     } else
+                        tree.insert(key, value);
+                  }
                }
                threads::onesided::Worker::my().counters.incr_by(profiling::WorkerCounters::latency,
                                                       utils::getTimePoint() - begin);
@@ -83,6 +83,7 @@ struct KVPair{
    Key key;
    Value value;
 };
+constexpr size_t MAX_VAR_KEY_LENGTH = 64; // variable-length keys of the two-sided var key tree
 using u64 = uint64_t;
 using s32 = int32_t;
 constexpr size_t BTREE_NODE_SIZE = 1024;
@@ -97,8 +98,36 @@ constexpr size_t PARTITIONS = 64;  // partitions for partitioned queue
 constexpr size_t BATCH_SIZE = 128; // for partitioned queue 
 constexpr bool USE_BACKOFF = true;
 constexpr size_t CONCURRENT_LATCHES = 8; // every worker can hold that many latches at the SAME time 
+constexpr size_t MAX_BLOB_SIZE = 4096; // largest out-of-line value of the one-sided tree
+constexpr size_t MAX_BLOB_BATCH = 64; // out-of-line values fetched with one batch of READs
+constexpr uint64_t BLOB_CHUNK_SIZE = 1ull << 20; // blob heap space a worker reserves with one FAA
+constexpr size_t MAX_READ_BATCH = 8; // sibling leaves a descending scan reads with one doorbell batch, clustered leaves an ascending scan reads with one READ
+constexpr size_t MAX_REPLICAS = 2; // further copies of a replicated inner node of the one-sided tree
+constexpr size_t SPLIT_HINT_SLOTS = 1024; // ring of split hints per storage node
+constexpr uint64_t CLUSTER_SCAN_PAGES = 256; // pages the leaf clusterer of a storage node inspects per step
+constexpr size_t STALE_HINT_SLOTS = 4096; // leaves per compute node whose fill hint was found too small
+constexpr size_t SPLIT_HINT_SLACK = 4; // free entries left in a node when it is announced to the split daemon
+constexpr size_t ROUTER_RANGES = 64; // key ranges with their own routing statistics in the adaptive router
+constexpr uint64_t ROUTER_EPOCH = 512; // operations of a range between two routing decisions
+constexpr uint64_t ROUTER_PROBE = 16; // every n-th point operation of a storage-routed range runs one-sided to keep measuring contention
+constexpr double ROUTER_CONTENTION_HIGH = 0.2; // latch failures and restarts per one-sided operation that route a range to the storage nodes
+constexpr double ROUTER_CONTENTION_LOW = 0.05; // below this a storage-routed range returns to one-sided execution
+constexpr uint64_t ROUTER_SCAN_ROWS = 512; // average rows per scan above which scans of a range run on the storage nodes
+constexpr size_t LEAF_CACHE_SKETCH_WIDTH = 4096; // counters per row of the frequency sketch of the compute-side leaf cache (power of 2)
+constexpr uint8_t LEAF_CACHE_ADMIT = 4; // estimated reads of a leaf before it is admitted to the leaf cache
+constexpr uint64_t LEAF_CACHE_AGING = 8 * LEAF_CACHE_SKETCH_WIDTH; // reads after which the sketch counters are halved
 
 constexpr auto ACTIVE_LOG_LEVEL = LOG_LEVEL::RELEASE;
+
+// one-sided leaf layout; storage and compute nodes must be built with the same layout
+enum class LEAF_LAYOUT {
+   PLAIN = 0,        // separate key and value arrays
+   FINGERPRINT = 1,  // key/value records with 1-byte fingerprints in the second CL; lookups read partial leaves
+   RECORDS = 2,      // contiguous key/value records; reads are truncated to the filled prefix
+   DELTA16 = 3,      // keys as 16-bit offsets from the lower fence (93 entries per 1KB node)
+   DELTA32 = 4,      // keys as 32-bit offsets from the lower fence (78 entries per 1KB node)
+};
+constexpr auto ACTIVE_LEAF_LAYOUT = LEAF_LAYOUT::RECORDS;
 // -------------------------------------------------------------------------------------
 struct DEBUG_ROW{
    uint64_t counter {0};
@@ -152,6 +181,15 @@ struct RemotePtr {
 
 constexpr NodeID EMPTY_NODEID (~uint64_t(0));
 static constexpr RemotePtr NULL_REMOTEPTR ((~uint8_t(0)), (~uint64_t(0)));
+// reference to an out-of-line value in the blob heap of a storage node
+struct BlobRef {
+   RemotePtr ptr = NULL_REMOTEPTR;
+   uint64_t length = 0;
+   friend std::ostream& operator<<(std::ostream& os, BlobRef& ref) {
+      os << ref.ptr << " length " << ref.length;
+      return os;
+   }
+};
 constexpr uint64_t EMPTY_PVERSION ((~uint64_t(0)));
 constexpr uint64_t EMPTY_EPOCH ((~uint64_t(0)));
 static constexpr uint64_t MAX_TABLES = 10;